@@ -56,4 +56,25 @@ std::string calculateHash(std::span<const uint8_t> data) {
     std::vector<uint8_t> hash(picosha2::k_digest_size);
     picosha2::hash256(data.begin(), data.end(), hash);
     return picosha2::bytes_to_hex_string(hash.begin(), hash.end());
-}
\ No newline at end of file
+}
+
+class HashCalculator::Impl final {
+public:
+    picosha2::hash256_one_by_one hasher;
+};
+
+HashCalculator::HashCalculator() : m_impl(std::make_unique<Impl>()) {}
+HashCalculator::~HashCalculator() = default;
+HashCalculator::HashCalculator(HashCalculator&&) = default;
+HashCalculator& HashCalculator::operator=(HashCalculator&&) = default;
+
+void HashCalculator::update(std::span<const uint8_t> data) {
+    m_impl->hasher.process(data.begin(), data.end());
+}
+
+std::string HashCalculator::finish() {
+    m_impl->hasher.finish();
+    std::vector<uint8_t> hash(picosha2::k_digest_size);
+    m_impl->hasher.get_hash_bytes(hash.begin(), hash.end());
+    return picosha2::bytes_to_hex_string(hash.begin(), hash.end());
+}
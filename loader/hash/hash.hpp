@@ -3,6 +3,7 @@
 #include <string>
 #include <filesystem>
 #include <span>
+#include <memory>
 
 std::string calculateSHA3_256(std::filesystem::path const& path);
 
@@ -15,3 +16,21 @@ std::string calculateSHA256Text(std::filesystem::path const& path);
  * used for verifying mods.
  */
 std::string calculateHash(std::span<const uint8_t> data);
+
+/**
+ * Calculates the same hash as calculateHash, but incrementally for data 
+ * that arrives in chunks (such as a download being streamed to disk)
+ */
+class HashCalculator final {
+    class Impl;
+    std::unique_ptr<Impl> m_impl;
+
+public:
+    HashCalculator();
+    ~HashCalculator();
+    HashCalculator(HashCalculator&&);
+    HashCalculator& operator=(HashCalculator&&);
+
+    void update(std::span<const uint8_t> data);
+    std::string finish();
+};
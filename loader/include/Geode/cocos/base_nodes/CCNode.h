@@ -875,8 +875,10 @@ public:
     
 private:
     friend class geode::modifier::FieldContainer;
+    friend class geode::modifier::FieldArena;
 
     GEODE_DLL geode::modifier::FieldContainer* getFieldContainer(char const* forClass);
+    GEODE_DLL geode::modifier::FieldArena* getFieldArena();
     GEODE_DLL void addEventListenerInternal(
         std::string const& id,
         geode::EventListenerProtocol* protocol
@@ -940,6 +942,14 @@ public:
      * @returns The first matching node, or nullptr if none was found
      */
     GEODE_DLL CCNode* querySelector(std::string_view query);
+    /**
+     * Get all nodes matching a query, in breadth-first order. See 
+     * querySelector for the query syntax. All matches are collected in a 
+     * single traversal of the tree
+     * @returns Every matching node, or an empty vector if none were found
+     * @note Geode addition
+     */
+    GEODE_DLL std::vector<CCNode*> querySelectorAll(std::string_view query);
 
     /** 
      * Removes a child from the container by its ID.
@@ -1002,10 +1012,36 @@ public:
     GEODE_DLL geode::Layout* getLayout();
     /**
      * Update the layout of this node using the current Layout. If no layout is 
-     * set, nothing happens
+     * set, nothing happens. If none of the inputs of an AxisLayout (the 
+     * children, their sizes, scales, positions, visibility and layout options) 
+     * have changed since it was last applied, the layout is not re-run
+     * @note If layout is suspended on this node, the update is deferred until 
+     * layout is resumed
      * @note Geode addition
      */
     GEODE_DLL void updateLayout(bool updateChildOrder = true);
+    /**
+     * Stop updateLayout from applying the layout on this node until 
+     * resumeLayout is called. Useful for building a node with lots of 
+     * children without the layout being re-run after each one is added. Calls 
+     * can be nested
+     * @note Prefer geode::LayoutSuspendScope over calling this manually
+     * @note Geode addition
+     */
+    GEODE_DLL void suspendLayout();
+    /**
+     * Undo a call to suspendLayout. Once every suspendLayout call has been 
+     * matched, the layout is updated once if updateLayout was called while it 
+     * was suspended
+     * @param apply Whether to run the deferred update or just drop it
+     * @note Geode addition
+     */
+    GEODE_DLL void resumeLayout(bool apply = true);
+    /**
+     * Check if layout is currently suspended on this node
+     * @note Geode addition
+     */
+    GEODE_DLL bool isLayoutSuspended();
     /**
      * Set the layout options for this node. Layout options can be used to 
      * control how this node is positioned in its parent's Layout, for example 
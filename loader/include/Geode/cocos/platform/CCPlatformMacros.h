@@ -125,6 +125,7 @@ namespace geode {
 
     namespace modifier {
         class FieldContainer;
+        class FieldArena;
 
         template <class Derived, class Base>
         class ModifyDerive;
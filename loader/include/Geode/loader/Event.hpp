@@ -4,10 +4,13 @@
 
 #include <Geode/DefaultInclude.hpp>
 #include <type_traits>
+#include <typeinfo>
 #include <mutex>
 #include <deque>
+#include <unordered_map>
 #include <unordered_set>
 #include <atomic>
+#include <vector>
 
 namespace geode {
     class Mod;
@@ -42,10 +45,42 @@ namespace geode {
     protected:
         // fix this in Geode 4.0.0
         struct Data {
+            struct Entry {
+                EventListenerProtocol* listener;
+                // Newer listeners get priority
+                size_t order;
+            };
+            // Every listener of the same type accepts the same events, so
+            // listeners are grouped by type and events are only tested
+            // against each group once
+            struct Group {
+                std::vector<Entry> listeners;
+                // Null if the listeners don't say which events they accept,
+                // in which case they get every event
+                bool(*check)(Event*) = nullptr;
+                bool hasRemoved = false;
+            };
+            // Which groups accept a concrete event type
+            struct Bucket {
+                std::vector<size_t> groups;
+                size_t seenGroups = 0;
+            };
+
             std::atomic_size_t m_locked = 0;
             std::mutex m_mutex;
-            std::deque<EventListenerProtocol*> m_listeners;
+            std::vector<Group> m_groups;
+            // Keyed by typeinfo address rather than name, since names aren't
+            // unique for types in anonymous namespaces on every platform
+            std::unordered_map<std::type_info const*, size_t> m_groupIndices;
+            std::unordered_map<EventListenerProtocol*, size_t> m_listenerGroups;
+            // Keyed by typeinfo address, which may differ between modules
+            // for the same type; that only means a few duplicate buckets
+            std::unordered_map<std::type_info const*, Bucket> m_buckets;
             std::vector<EventListenerProtocol*> m_toAdd;
+            size_t m_nextOrder = 0;
+
+            void insert(EventListenerProtocol* listener);
+            Bucket& bucketFor(Event* event);
         };
         std::unique_ptr<Data> m_data;
 
@@ -71,6 +106,15 @@ namespace geode {
     private:
         EventListenerPool* m_pool = nullptr;
 
+    protected:
+        /**
+         * Tell the pool which events this listener handles, so it isn't given
+         * any others. Must be called before `enable`. Pools cache the result 
+         * for each event type, so the check must not depend on anything else 
+         * about the event. Listeners that don't set a check get every event
+         */
+        void setEventCheck(bool(*check)(Event*));
+
     public:
         bool enable();
         void disable();
@@ -150,6 +194,7 @@ namespace geode {
 
         EventListener(T filter = T()) : m_filter(filter) {
             m_filter.setListener(this);
+            this->setEventCheck(&EventListener::isAccepted);
             this->enable();
         }
 
@@ -157,11 +202,13 @@ namespace geode {
           : m_callback(fn), m_filter(filter)
         {
             m_filter.setListener(this);
+            this->setEventCheck(&EventListener::isAccepted);
             this->enable();
         }
 
         EventListener(Callback* fnptr, T filter = T()) : m_callback(fnptr), m_filter(filter) {
             m_filter.setListener(this);
+            this->setEventCheck(&EventListener::isAccepted);
             this->enable();
         }
 
@@ -170,6 +217,7 @@ namespace geode {
             EventListener(std::bind(fn, cls, std::placeholders::_1), filter)
         {
             m_filter.setListener(this);
+            this->setEventCheck(&EventListener::isAccepted);
             this->enable();
         }
 
@@ -179,6 +227,7 @@ namespace geode {
         {
             m_filter.setListener(this);
             other.disable();
+            this->setEventCheck(&EventListener::isAccepted);
             this->enable();
         }
 
@@ -187,6 +236,7 @@ namespace geode {
             m_filter(other.m_filter)
         {
             m_filter.setListener(this);
+            this->setEventCheck(&EventListener::isAccepted);
             this->enable();
         }
 
@@ -219,6 +269,11 @@ namespace geode {
     protected:
         std::function<Callback> m_callback = nullptr;
         T m_filter;
+
+    private:
+        static bool isAccepted(Event* e) {
+            return cast::typeinfo_cast<typename T::Event*>(e) != nullptr;
+        }
     };
 
     class GEODE_DLL [[nodiscard]] Event {
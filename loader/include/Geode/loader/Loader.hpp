@@ -8,6 +8,7 @@
 #include "Types.hpp"
 
 #include <atomic>
+#include <chrono>
 #include <matjson.hpp>
 #include <mutex>
 #include <optional>
@@ -16,6 +17,28 @@
 namespace geode {
     using ScheduledFunction = std::function<void()>;
 
+    /**
+     * Lanes for functions queued to run on the main thread. Higher lanes run 
+     * first, and only the High lane ignores the per-frame time budget
+     */
+    enum class MainThreadPriority {
+        Low,
+        Normal,
+        High,
+    };
+
+    struct MainThreadQueueStats final {
+        // Functions still waiting to run
+        size_t backlog = 0;
+        // Total number of functions run so far
+        size_t executed = 0;
+        // Frames that left functions for the next frame due to the budget
+        size_t deferredFrames = 0;
+        // Time spent running queued functions on the last frame
+        std::chrono::microseconds lastDrainTime {};
+        std::chrono::microseconds maxDrainTime {};
+    };
+
     struct InvalidGeodeFile {
         std::filesystem::path path;
         std::string reason;
@@ -151,6 +174,20 @@ namespace geode {
         }
 
         void queueInMainThread(ScheduledFunction&& func);
+        void queueInMainThread(ScheduledFunction&& func, MainThreadPriority priority);
+
+        /**
+         * Set how long the main thread may spend running queued functions 
+         * each frame before leaving the rest for the next frame. There is no 
+         * budget by default
+         * @param budget The time budget, or nullopt to always run everything
+         */
+        void setMainThreadQueueBudget(std::optional<std::chrono::microseconds> budget);
+        /**
+         * Get timing and backlog information about the main thread queue. 
+         * Should only be called from the main thread
+         */
+        MainThreadQueueStats getMainThreadQueueStats() const;
 
         /**
          * Returns the current game version.
@@ -172,6 +209,16 @@ namespace geode {
         Loader::get()->queueInMainThread(std::forward<ScheduledFunction>(func));
     }
 
+    /**
+     * @brief Queues a function to run on the main thread in the given lane
+     * 
+     * @param func the function to queue
+     * @param priority the lane to queue the function in
+    */
+    inline GEODE_HIDDEN void queueInMainThread(ScheduledFunction&& func, MainThreadPriority priority) {
+        Loader::get()->queueInMainThread(std::forward<ScheduledFunction>(func), priority);
+    }
+
     /**
      * @brief Take the next mod to load
      *
@@ -233,6 +233,23 @@ namespace geode {
             return T();
         }
 
+        /**
+         * Get a handle for reading the value of a setting in hot paths, such 
+         * as hooks that run every frame. Unlike `getSettingValue`, the setting 
+         * is only looked up once, and reading the handle is just a load. See 
+         * `SettingHandle` for details
+         * @returns The handle, or an error if the setting doesn't exist or 
+         * isn't of the requested type
+         */
+        template <class T>
+        Result<SettingHandle<T>> getSettingHandle(std::string_view key) const {
+            using S = typename SettingTypeForValueType<T>::SettingType;
+            if (auto sett = cast::typeinfo_pointer_cast<S>(this->getSetting(key))) {
+                return Ok(SettingHandle<T>(sett));
+            }
+            return Err("Setting '{}' doesn't exist or isn't of the requested type", key);
+        }
+
         template <class T>
         T setSettingValue(std::string_view key, T const& value) {
             using S = typename SettingTypeForValueType<T>::SettingType;
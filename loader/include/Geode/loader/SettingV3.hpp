@@ -747,6 +747,64 @@ namespace geode {
         using T = std::remove_cvref_t<utils::function::Arg<0, decltype(callback)>>;
         return listenForSettingChangesV3<T>(settingKey, std::move(callback), mod);
     }
+    /**
+     * A resolved, typed handle to a setting, for reading its value in hot 
+     * paths like per-frame hooks. The setting is looked up once when the 
+     * handle is created, and the handle keeps its own copy of the value that 
+     * is updated through `SettingChangedEventV3`, so reading it involves no 
+     * lookups or casts. Get one through `Mod::getSettingHandle`
+     * @note The value is updated on the main thread, so the handle should 
+     * only be read there
+     */
+    template <class T>
+    class SettingHandle final {
+    public:
+        using SettingType = typename SettingTypeForValueType<T>::SettingType;
+
+    private:
+        // Kept on the heap so the listener can point to it while the handle 
+        // itself is moved around
+        struct State final {
+            T value;
+            std::shared_ptr<SettingType> setting;
+            EventListener<SettingChangedFilterV3> listener;
+
+            State(std::shared_ptr<SettingType> setting)
+              : value(setting->getValue()),
+                setting(setting),
+                listener(SettingChangedFilterV3(setting->getModID(), setting->getKey())) {}
+        };
+        std::unique_ptr<State> m_state;
+
+    public:
+        explicit SettingHandle(std::shared_ptr<SettingType> setting)
+          : m_state(std::make_unique<State>(std::move(setting)))
+        {
+            m_state->listener.bind([state = m_state.get()](std::shared_ptr<SettingV3> setting) {
+                if (setting == state->setting) {
+                    state->value = state->setting->getValue();
+                }
+            });
+        }
+
+        /**
+         * Get the current value of the setting
+         */
+        T const& get() const {
+            return m_state->value;
+        }
+        T const& operator*() const {
+            return m_state->value;
+        }
+        T const* operator->() const {
+            return &m_state->value;
+        }
+
+        std::shared_ptr<SettingType> getSetting() const {
+            return m_state->setting;
+        }
+    };
+
     GEODE_DLL EventListener<SettingChangedFilterV3>* listenForAllSettingChangesV3(
         std::function<void(std::shared_ptr<SettingV3>)> const& callback,
         Mod* mod = getMod()
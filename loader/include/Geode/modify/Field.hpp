@@ -4,6 +4,7 @@
 
 #include <Geode/loader/Loader.hpp>
 #include <cocos2d.h>
+#include <cstddef>
 #include <vector>
 
 namespace cocos2d {
@@ -16,6 +17,11 @@ namespace geode {
 }
 
 namespace geode::modifier {
+    /**
+     * Per-class field storage used by mods built against older headers. Its
+     * layout and methods are compiled into those mods, so it must not change
+     * within a major version; new code uses FieldArena instead
+     */
     class FieldContainer {
     private:
         std::vector<void*> m_containedFields;
@@ -50,7 +56,66 @@ namespace geode::modifier {
         }
     };
 
+    /**
+     * Storage for the fields of every $modify class on a single node. All the
+     * field blocks are placed one after another in an arena, the first part of
+     * which is stored inline in the arena itself, so a node with fields from
+     * a few mods only needs a single allocation for all of them
+     */
+    class GEODE_DLL FieldArena final {
+    public:
+        using Destructor = void(*)(void*);
+
+        // Bytes of field storage kept inline before more memory is allocated
+        static constexpr size_t INLINE_SIZE = 256;
+
+    private:
+        struct Block;
+        struct Chunk;
+
+        // Newest first, so fields are destroyed in reverse order of creation
+        Block* m_blocks = nullptr;
+        // Memory allocated after the inline storage ran out
+        Chunk* m_chunks = nullptr;
+        std::byte* m_cursor;
+        std::byte* m_end;
+        alignas(std::max_align_t) std::byte m_inline[INLINE_SIZE];
+
+        void* allocate(size_t size, size_t align);
+
+    public:
+        FieldArena();
+        ~FieldArena();
+
+        FieldArena(FieldArena const&) = delete;
+        FieldArena& operator=(FieldArena const&) = delete;
+
+        /**
+         * Get the fields with the given index, or nullptr if they haven't
+         * been created yet
+         */
+        void* getField(size_t classIndex, size_t index);
+        /**
+         * Allocate the uninitialized storage for the fields with the given
+         * index. The destructor is called on it when the node is destroyed
+         */
+        void* setField(size_t classIndex, size_t index, size_t size, size_t align, Destructor destructor);
+
+        static FieldArena* from(cocos2d::CCNode* node) {
+            return node->getFieldArena();
+        }
+    };
+
+    /**
+     * Get the index of the next set of fields for a class. The index is
+     * global across all mods
+     */
     GEODE_DLL size_t getFieldIndexForClass(char const* name);
+    /**
+     * Get a small integer uniquely identifying a class by its type name,
+     * which is the same across all mods
+     */
+    GEODE_DLL size_t getFieldClassIndex(char const* name);
 
     template <class Parent, class Base>
     class FieldIntermediate {
@@ -77,19 +142,23 @@ namespace geode::modifier {
             auto node = reinterpret_cast<Parent*>(reinterpret_cast<std::byte*>(this) - sizeof(Base));
             // static_assert(sizeof(Base) + sizeof() == sizeof(Intermediate), "offsetof not correct");
 
-            // generating the container if it doesn't exist
-            auto container = FieldContainer::from(node, typeid(Base).name());
+            // generating the arena if it doesn't exist
+            auto arena = FieldArena::from(node);
 
-            // the index is global across all mods, so the
-            // function is defined in the loader source
+            // the indices are global across all mods, so the
+            // functions are defined in the loader source; they
+            // only ever get resolved once per modify class
+            static size_t classIndex = getFieldClassIndex(typeid(Base).name());
             static size_t index = getFieldIndexForClass(typeid(Base).name());
 
             // the fields are actually offset from their original
             // offset, this is done to save on allocation and space
-            auto offsetField = container->getField(index);
+            auto offsetField = arena->getField(classIndex, index);
             if (!offsetField) {
-                offsetField = container->setField(
-                    index, sizeof(typename Parent::Fields), &FieldIntermediate::fieldDestructor
+                offsetField = arena->setField(
+                    classIndex, index,
+                    sizeof(typename Parent::Fields), alignof(typename Parent::Fields),
+                    &FieldIntermediate::fieldDestructor
                 );
 
                 FieldIntermediate::fieldConstructor(offsetField);
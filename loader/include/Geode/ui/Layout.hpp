@@ -49,6 +49,40 @@ public:
     virtual ~LayoutOptions() = default;
 };
 
+/**
+ * Suspends layout on a node for as long as the scope lives, so that all the 
+ * updateLayout calls made while e.g. adding children collapse into a single 
+ * layout pass when the scope ends
+ * @example
+ * {
+ *     LayoutSuspendScope scope(menu);
+ *     for (auto btn : buttons) {
+ *         menu->addChild(btn);
+ *         menu->updateLayout();
+ *     }
+ * } // The layout of menu is only applied here
+ */
+class [[nodiscard]] LayoutSuspendScope final {
+    cocos2d::CCNode* m_node;
+
+public:
+    LayoutSuspendScope(cocos2d::CCNode* node) : m_node(node) {
+        if (m_node) {
+            m_node->retain();
+            m_node->suspendLayout();
+        }
+    }
+    ~LayoutSuspendScope() {
+        if (m_node) {
+            m_node->resumeLayout();
+            m_node->release();
+        }
+    }
+
+    LayoutSuspendScope(LayoutSuspendScope const&) = delete;
+    LayoutSuspendScope& operator=(LayoutSuspendScope const&) = delete;
+};
+
 /**
  * The direction of an AxisLayout
  */
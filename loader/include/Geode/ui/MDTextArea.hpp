@@ -65,8 +65,9 @@ namespace geode {
         static MDTextArea* create(std::string const& str, cocos2d::CCSize const& size);
 
         /**
-         * Update the label's content; call
-         * sparingly as rendering may be slow
+         * Update the label's content. Parsed markdown is
+         * cached, and long content is laid out a block at a
+         * time as it's scrolled into view
          */
         void updateLabel();
 
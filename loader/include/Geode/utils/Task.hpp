@@ -3,17 +3,54 @@
 #include "general.hpp"
 #include "../loader/Event.hpp"
 #include "../loader/Loader.hpp"
+#include <chrono>
+#include <functional>
 #include <mutex>
+#include <unordered_map>
 #include <string_view>
 #include <coroutine>
 
 namespace geode {
+    /**
+     * How urgently a Task should be started compared to other Tasks waiting 
+     * for a free thread
+     */
+    enum class TaskPriority {
+        /// Work nobody is waiting on yet, such as prefetching
+        Background,
+        Normal,
+        /// Work whose result the user is currently looking at
+        High,
+    };
+
+    /**
+     * Counters for the thread pool that Task bodies are run on
+     */
+    struct TaskPoolStats final {
+        size_t workers = 0;
+        // Temporary threads started because every worker was busy for too long
+        size_t overflowWorkers = 0;
+        size_t queued = 0;
+        size_t running = 0;
+        size_t completed = 0;
+        // How many Tasks were taken from another worker's queue
+        size_t stolen = 0;
+        // How long Tasks waited in the queue before being started
+        std::chrono::microseconds totalWait {};
+        std::chrono::microseconds maxWait {};
+    };
+
+    GEODE_DLL TaskPoolStats getTaskPoolStats();
+
     namespace geode_internal {
         template <class T, class P>
         struct TaskPromise;
 
         template <class T, class P>
         struct TaskAwaiter;
+
+        // Queues a job on the thread pool shared by all Tasks
+        GEODE_DLL void enqueueTask(std::function<void()> job, TaskPriority priority);
     }
 
     /**
@@ -277,6 +314,22 @@ namespace geode {
 
         Task(std::shared_ptr<Handle> handle) : m_handle(handle) {}
 
+        // The latest progress value of each Task that hasn't been posted yet; 
+        // reports made before the main thread gets to it replace the value 
+        // instead of queueing another event. This is kept outside of `Handle` 
+        // because mods built against older headers share `Handle`'s layout, 
+        // so its members can't change within a major version
+        struct PendingProgress final {
+            std::mutex mutex;
+            std::unordered_map<Handle*, std::optional<P>> values;
+        };
+        static PendingProgress& pendingProgress() {
+            // Leaked on purpose so that progress events still queued at exit 
+            // never touch a destroyed table
+            static auto pending = new PendingProgress();
+            return *pending;
+        }
+
         static void finish(std::shared_ptr<Handle> handle, T&& value) {
             if (!handle) return;
             std::unique_lock<std::recursive_mutex> lock(handle->m_mutex);
@@ -296,8 +349,26 @@ namespace geode {
             if (!handle) return;
             std::unique_lock<std::recursive_mutex> lock(handle->m_mutex);
             if (handle->m_status == Status::Pending) {
-                queueInMainThread([handle, value = std::move(value)]() mutable {
-                    Event::createProgressed(handle, &value).post();
+                {
+                    auto& pending = pendingProgress();
+                    std::unique_lock<std::mutex> pendingLock(pending.mutex);
+                    auto& slot = pending.values[handle.get()];
+                    bool queued = slot.has_value();
+                    slot.emplace(std::move(value));
+                    if (queued) return;
+                }
+                // The closure keeps the Handle alive, so its address can't be 
+                // reused by another Task until the entry has been taken out
+                queueInMainThread([handle]() mutable {
+                    typename decltype(PendingProgress::values)::node_type node;
+                    {
+                        auto& pending = pendingProgress();
+                        std::unique_lock<std::mutex> pendingLock(pending.mutex);
+                        node = pending.values.extract(handle.get());
+                    }
+                    if (node && node.mapped()) {
+                        Event::createProgressed(handle, &*node.mapped()).post();
+                    }
                 });
             }
         }
@@ -434,12 +505,21 @@ namespace geode {
          * Create a new Task with a function that returns the finished value. 
          * See the class description for details about Tasks
          * @param body The body aka actual code of the Task. Note that this 
-         * function MUST be synchronous - Task creates the thread for you!
+         * function MUST be synchronous - Task runs it on a thread for you!
          * @param name The name of the Task; used for debugging
+         * @param priority How soon the Task should be started if the thread 
+         * pool is busy
          */
-        static Task run(Run&& body, std::string_view name = "<Task>") {
+        static Task run(Run&& body, std::string_view name = "<Task>", TaskPriority priority = TaskPriority::Normal) {
             auto task = Task(Handle::create(name));
-            std::thread([handle = std::weak_ptr(task.m_handle), name = std::string(name), body = std::move(body)] {
+            geode_internal::enqueueTask([handle = std::weak_ptr(task.m_handle), name = std::string(name), body = std::move(body)] {
+                // Don't start at all if the Task was cancelled while queued
+                if (auto lock = handle.lock(); !(lock && lock->is(Status::Pending))) {
+                    return;
+                }
+                // Pool workers run many Tasks, so their own name is restored 
+                // once this one is done
+                auto workerName = utils::thread::getName();
                 utils::thread::setName(fmt::format("Task '{}'", name));
                 auto result = body(
                     [handle](P progress) {
@@ -452,13 +532,14 @@ namespace geode {
                         return !(lock && lock->is(Status::Pending));
                     }
                 );
+                utils::thread::setName(workerName);
                 if (result.isCancelled()) {
                     Task::cancel(handle.lock());
                 }
                 else {
                     Task::finish(handle.lock(), std::move(*std::move(result).getValue()));
                 }
-            }).detach();
+            }, priority);
             return task;
         }
         /**
@@ -469,10 +550,17 @@ namespace geode {
          * call its provided finish callback *exactly once* - subsequent 
          * calls will always be ignored
          * @param name The name of the Task; used for debugging
+         * @param priority How soon the Task should be started if the thread 
+         * pool is busy
          */
-        static Task runWithCallback(RunWithCallback&& body, std::string_view name = "<Callback Task>") {
+        static Task runWithCallback(RunWithCallback&& body, std::string_view name = "<Callback Task>", TaskPriority priority = TaskPriority::Normal) {
             auto task = Task(Handle::create(name));
-            std::thread([handle = std::weak_ptr(task.m_handle), name = std::string(name), body = std::move(body)] {
+            geode_internal::enqueueTask([handle = std::weak_ptr(task.m_handle), name = std::string(name), body = std::move(body)] {
+                // Don't start at all if the Task was cancelled while queued
+                if (auto lock = handle.lock(); !lock || lock->is(Status::Cancelled)) {
+                    return;
+                }
+                auto workerName = utils::thread::getName();
                 utils::thread::setName(fmt::format("Task '{}'", name));
                 body(
                     [handle](Result result) {
@@ -493,7 +581,8 @@ namespace geode {
                         return !lock || lock->is(Status::Cancelled);
                     }
                 );
-            }).detach();
+                utils::thread::setName(workerName);
+            }, priority);
             return task;
         }
         /**
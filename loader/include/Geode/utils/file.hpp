@@ -196,6 +196,17 @@ namespace geode::utils::file {
          * @param dir Directory to unzip the contents to
          */
         Result<> extractAllTo(Path const& dir);
+        /**
+         * Extract all entries to directory, skipping entries whose CRC-32 and 
+         * size match the previous extraction and deleting files for entries 
+         * that have since been removed from the zip. Each file is written to 
+         * a temporary path and moved into place
+         * @param dir Directory to unzip the contents to
+         * @param manifest File that records what was extracted. It is only 
+         * written once everything has been extracted, so an interrupted 
+         * extraction is redone in full next time
+         */
+        Result<> extractAllToIncremental(Path const& dir, Path const& manifest);
 
         /**
          * Helper method for quickly unzipping a file
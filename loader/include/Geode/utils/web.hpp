@@ -9,6 +9,15 @@
 
 namespace geode::utils::web {
     GEODE_DLL void openLinkInBrowser(std::string const& url);
+
+    /**
+     * Limit how many connections are opened to a single host at once. All 
+     * WebRequests share one pool of connections; requests beyond the limit 
+     * wait until a connection to that host frees up. Defaults to 6
+     * @param count The maximum number of connections per host, or 0 for no 
+     * limit
+     */
+    GEODE_DLL void setMaxConnectionsPerHost(size_t count);
     
     // https://curl.se/libcurl/c/CURLOPT_HTTPAUTH.html
     namespace http_auth {
@@ -80,6 +89,12 @@ namespace geode::utils::web {
         Result<matjson::Value> json() const;
         ByteVector data() const;
         Result<> into(std::filesystem::path const& path) const;
+        /**
+         * The SHA-256 hash of the response body, calculated while it was being 
+         * written to disk. Only set for successful responses to requests made 
+         * with WebRequest::downloadTo
+         */
+        std::optional<std::string> sha256() const;
 
         std::vector<std::string> headers() const;
         std::optional<std::string> header(std::string_view name) const;
@@ -175,6 +190,44 @@ namespace geode::utils::web {
          */
         WebRequest& timeout(std::chrono::seconds time);
 
+        /**
+         * Streams the body of a successful response into a file as it arrives 
+         * instead of keeping it in memory. The file only appears at the given 
+         * path once the whole transfer has succeeded, so it never contains a 
+         * partial download. The response's data() will be empty, but sha256() 
+         * holds the hash of the downloaded file. Error responses are still 
+         * kept in memory so their message can be read
+         *
+         * @param path The file to download to
+         * @return WebRequest&
+         */
+        WebRequest& downloadTo(std::filesystem::path const& path);
+
+        /**
+         * Store successful GET responses in Geode's on-disk HTTP cache and 
+         * reuse them for as long as their Cache-Control, Expires and 
+         * Last-Modified headers allow. Once a cached response goes stale, the 
+         * request is sent with its ETag / Last-Modified validators so the body 
+         * is only downloaded again if it has changed. If the server can't be 
+         * reached, the cached response is used instead.
+         * The default is false.
+         *
+         * @param enabled
+         * @return WebRequest&
+         */
+        WebRequest& cache(bool enabled);
+
+        /**
+         * Allow a stale cached response to be used immediately for up to 
+         * `maxStale` past its freshness, while it's refreshed in the background 
+         * for the next request. If the server's own stale-while-revalidate is 
+         * longer, that is used instead. Implies cache(true).
+         *
+         * @param maxStale
+         * @return WebRequest&
+         */
+        WebRequest& staleWhileRevalidate(std::chrono::seconds maxStale);
+
         /**
          * Sets the target byte range to request.
          * Defaults to receiving the full request.
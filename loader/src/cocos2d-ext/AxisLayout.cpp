@@ -142,7 +142,7 @@ public:
     std::optional<float> m_autoGrowAxisMinLength;
     std::pair<float, float> m_defaultScaleLimits = { AXISLAYOUT_DEFAULT_MIN_SCALE, 1 };
 
-    struct Row : public CCObject {
+    struct Row {
         float nextOverflowScaleDownFactor;
         float nextOverflowSquishFactor;
         float axisLength;
@@ -177,9 +177,7 @@ public:
             scale(scale),
             squish(squish),
             prio(prio)
-        {
-            this->autorelease();
-        }
+        {}
 
         void accountSpacers(Axis axis, float availableLength, float crossLength) {
             std::vector<SpacerNode*> spacers;
@@ -302,7 +300,7 @@ public:
         return gap.value_or(ix ? m_gap : 0);
     }
 
-    Row* fitInRow(
+    Row fitInRow(
         CCNode* on, CCArray* nodes,
         std::pair<int, int> const& minMaxPrios,
         bool doAutoScale,
@@ -394,8 +392,63 @@ public:
         auto squishFactor = available.axisLength / (axisUnsquishedLength + .01f) * squish;
 
         // calculate row scale, squish, and prio
+        // while the priority stays the same, every try just lowers the scale 
+        // by .004 (canTryScalingDown lowers it by .002 and then so does this 
+        // loop), and the row only gets shorter as the scale goes down; so 
+        // rather than fitting the row at every step, binary search for the 
+        // first step that fits
         int tries = 1000;
+        auto const minScale = this->minScaleForPrio(res, prio);
+        std::vector<float> steps;
         while (axisLength > available.axisLength) {
+            steps.clear();
+            auto next = scale;
+            while (steps.size() < static_cast<size_t>(tries) + 1) {
+                auto down = next - .002f;
+                if (down < minScale || fabsf(down - next) < .001f) {
+                    break;
+                }
+                next = down - .002f;
+                steps.push_back(next);
+            }
+            if (steps.size()) {
+                size_t low = 0;
+                size_t high = steps.size() - 1;
+                std::optional<size_t> fitted;
+                while (low <= high) {
+                    auto mid = low + (high - low) / 2;
+                    scale = steps[mid];
+                    fit(res);
+                    fitted = mid;
+                    if (axisLength > available.axisLength) {
+                        low = mid + 1;
+                    }
+                    else if (mid == 0) {
+                        break;
+                    }
+                    else {
+                        high = mid - 1;
+                    }
+                }
+                // the row has to end up fitted at the step that was chosen
+                auto chosen = std::min(low, steps.size() - 1);
+                if (fitted != chosen) {
+                    scale = steps[chosen];
+                    fit(res);
+                }
+                tries -= static_cast<int>(chosen + 1);
+                // Avoid infinite loops
+                if (tries < 0) {
+                    break;
+                }
+                continue;
+            }
+
+            // out of steps for this priority, so either move on to the next 
+            // priority or squish the row
+            auto prevScale = scale;
+            auto prevSquish = squish;
+            auto prevPrio = prio;
             if (this->canTryScalingDown(res, prio, scale, scale - .002f, minMaxPrios)) {
                 scale -= .002f;
             }
@@ -407,6 +460,10 @@ public:
             if (tries-- <= 0) {
                 break;
             }
+            // once squished, trying again would just give the same result
+            if (scale == prevScale && squish == prevSquish && prio == prevPrio) {
+                break;
+            }
         }
 
         // reverse row if needed
@@ -426,7 +483,7 @@ public:
             );
         }
 
-        return new Row(
+        return Row(
             // how much should the nodes be scaled down to fit the next row
             // the .01f is because floating point arithmetic is imprecise and you 
             // end up in a situation where it confidently tells you that
@@ -453,7 +510,7 @@ public:
         // like i genuinely have no clue fr why some of these work tho, 
         // i just threw in random equations and numbers until it worked
 
-        auto rows = CCArray::create();
+        std::vector<Row> rows;
         float maxRowAxisLength = 0.f;
         float totalRowCrossLength = 0.f;
         float crossScaleDownFactor = 0.f;
@@ -475,31 +532,31 @@ public:
                 minMaxPrios, doAutoScale,
                 scale, squish, prio
             );
-            rows->addObject(row);
+            rows.push_back(row);
             if (
-                row->nextOverflowScaleDownFactor > crossScaleDownFactor &&
-                row->nextOverflowScaleDownFactor < scale
+                row.nextOverflowScaleDownFactor > crossScaleDownFactor &&
+                row.nextOverflowScaleDownFactor < scale
             ) {
-                crossScaleDownFactor = row->nextOverflowScaleDownFactor;
+                crossScaleDownFactor = row.nextOverflowScaleDownFactor;
             }
             if (
-                row->nextOverflowSquishFactor > crossSquishFactor &&
-                row->nextOverflowSquishFactor < squish
+                row.nextOverflowSquishFactor > crossSquishFactor &&
+                row.nextOverflowSquishFactor < squish
             ) {
-                crossSquishFactor = row->nextOverflowSquishFactor;
+                crossSquishFactor = row.nextOverflowSquishFactor;
             }
-            totalRowCrossLength += row->crossLength;
+            totalRowCrossLength += row.crossLength;
             if (ix) {
                 totalRowCrossLength += m_gap;
             }
-            if (row->axisLength > maxRowAxisLength) {
-                maxRowAxisLength = row->axisLength;
+            if (row.axisLength > maxRowAxisLength) {
+                maxRowAxisLength = row.axisLength;
             }
             ix++;
         }
         newNodes->release();
 
-        if (!rows->count()) {
+        if (rows.empty()) {
             return;
         }
 
@@ -518,7 +575,6 @@ public:
             depth < RECURSION_DEPTH_LIMIT
         ) {
             if (this->canTryScalingDown(nodes, prio, scale, crossScaleDownFactor, minMaxPrios)) {
-                rows->release();
                 return this->tryFitLayout(
                     on, nodes,
                     minMaxPrios, doAutoScale,
@@ -540,7 +596,6 @@ public:
                 !m_growCrossAxis ||
                 totalRowCrossLength / available.crossLength < crossSquishFactor
             ) {
-                rows->release();
                 return this->tryFitLayout(
                     on, nodes,
                     minMaxPrios, doAutoScale,
@@ -553,7 +608,7 @@ public:
         // if we're here, the nodes are ready to be positioned
 
         if (m_crossReverse) {
-            rows->reverseObjects();
+            std::reverse(rows.begin(), rows.end());
         }
 
         // resize cross axis if needed
@@ -580,10 +635,8 @@ public:
         }
 
         float rowsEndsLength = 0.f;
-        if (rows->count()) {
-            auto first = static_cast<Row*>(rows->firstObject());
-            auto last = static_cast<Row*>(rows->lastObject());
-            rowsEndsLength = first->crossLength / 2 + last->crossLength / 2;
+        if (rows.size()) {
+            rowsEndsLength = rows.front().crossLength / 2 + rows.back().crossLength / 2;
         }
 
         float rowCrossPos;
@@ -609,27 +662,27 @@ public:
             } break;
         }
 
-        float rowEvenSpace = available.crossLength / rows->count();
+        float rowEvenSpace = available.crossLength / rows.size();
         
         float rowCrossLengthTotal = ranges::reduce<float>(
-            CCArrayExt<Row*>(rows),
-            [](float& acc, Row* row) {
-                acc += row->crossLength;
+            rows,
+            [](float& acc, Row const& row) {
+                acc += row.crossLength;
             }
         );
-        float rowCrossBetweenSpace = std::max(0.f, (available.crossLength - rowCrossLengthTotal) / std::max(rows->count() - 1, 1u));
+        float rowCrossBetweenSpace = std::max(0.f, (available.crossLength - rowCrossLengthTotal) / std::max<size_t>(rows.size() - 1, 1));
 
-        for (auto row : CCArrayExt<Row*>(rows)) {
-            row->accountSpacers(m_axis, available.axisLength, available.crossLength);
+        for (auto& row : rows) {
+            row.accountSpacers(m_axis, available.axisLength, available.crossLength);
 
             if (m_crossAlignment == AxisAlignment::Even) {
-                rowCrossPos -= rowEvenSpace / 2 + row->crossLength / 2;
+                rowCrossPos -= rowEvenSpace / 2 + row.crossLength / 2;
             }
             else if (m_crossAlignment == AxisAlignment::Between) {
-                rowCrossPos -= row->crossLength * columnSquish;
+                rowCrossPos -= row.crossLength * columnSquish;
             }
             else {
-                rowCrossPos -= row->crossLength * columnSquish;
+                rowCrossPos -= row.crossLength * columnSquish;
             }
 
             // starting axis pos
@@ -642,46 +695,46 @@ public:
                 } break;
 
                 case AxisAlignment::Center: {
-                    rowAxisPos = available.axisLength / 2 - row->axisLength / 2;
+                    rowAxisPos = available.axisLength / 2 - row.axisLength / 2;
                 } break;
 
                 case AxisAlignment::End: {
-                    rowAxisPos = available.axisLength - row->axisLength;
+                    rowAxisPos = available.axisLength - row.axisLength;
                 } break;
             }
 
             float rowLengthTotal = 0.f;
-            for (auto& node : CCArrayExt<CCNode*>(row->nodes)) {
+            for (auto& node : CCArrayExt<CCNode*>(row.nodes)) {
                 auto opts = axisOpts(node);
                 // rescale node if overflowing
                 // do not scale spacers since that screws up their content size
                 if (this->shouldAutoScale(opts) && !typeinfo_cast<SpacerNode*>(node)) {
-                    auto nodeScale = scaleByOpts(opts, row->scale, row->prio, false, m_defaultScaleLimits.first, m_defaultScaleLimits.second);
+                    auto nodeScale = scaleByOpts(opts, row.scale, row.prio, false, m_defaultScaleLimits.first, m_defaultScaleLimits.second);
                     // CCMenuItemSpriteExtra is quirky af
                     if (auto btn = typeinfo_cast<CCMenuItemSpriteExtra*>(node)) {
                         btn->m_baseScale = nodeScale;
                     }
                     node->setScale(nodeScale);
                 }
-                auto pos = nodeAxis(node, m_axis, row->squish);
+                auto pos = nodeAxis(node, m_axis, row.squish);
                 rowLengthTotal += pos.axisLength;
             }
-            float evenSpace = available.axisLength / row->nodes->count();
-            float rowBetweenSpace = std::max(0.f, (available.axisLength - rowLengthTotal) / std::max(row->nodes->count() - 1, 1u));
+            float evenSpace = available.axisLength / row.nodes->count();
+            float rowBetweenSpace = std::max(0.f, (available.axisLength - rowLengthTotal) / std::max(row.nodes->count() - 1, 1u));
 
             size_t ix = 0;
             AxisLayoutOptions const* prev = nullptr;
-            for (auto& node : CCArrayExt<CCNode*>(row->nodes)) {
+            for (auto& node : CCArrayExt<CCNode*>(row.nodes)) {
                 auto opts = axisOpts(node);
                 if (ix == 0) {
-                    rowAxisPos += row->axisEndsLength * row->scale / 2 * (1.f - row->squish);
+                    rowAxisPos += row.axisEndsLength * row.scale / 2 * (1.f - row.squish);
                 }
-                auto pos = nodeAxis(node, m_axis, row->squish);
+                auto pos = nodeAxis(node, m_axis, row.squish);
                 float axisPos;
                 if (m_axisAlignment == AxisAlignment::Even) {
                     axisPos = rowAxisPos + evenSpace / 2 - pos.axisLength * (.5f - pos.axisAnchor);
                     rowAxisPos += evenSpace - 
-                        row->axisEndsLength * row->scale * (1.f - row->squish) * 1.f / nodes->count();
+                        row.axisEndsLength * row.scale * (1.f - row.squish) * 1.f / nodes->count();
                 }
                 else if (m_axisAlignment == AxisAlignment::Between) {
                     axisPos = rowAxisPos + pos.axisLength * pos.axisAnchor;
@@ -689,16 +742,16 @@ public:
                 }
                 else {
                     if (ix != 0) {
-                        if (row->prio == minMaxPrios.first) {
-                            rowAxisPos += this->nextGap(prev, opts, ix) * row->scale * row->squish;
+                        if (row.prio == minMaxPrios.first) {
+                            rowAxisPos += this->nextGap(prev, opts, ix) * row.scale * row.squish;
                         }
                         else {
-                            rowAxisPos += this->nextGap(prev, opts, ix) * row->squish;
+                            rowAxisPos += this->nextGap(prev, opts, ix) * row.squish;
                         }
                     }
                     axisPos = rowAxisPos + pos.axisLength * pos.axisAnchor;
                     rowAxisPos += pos.axisLength - 
-                        row->axisEndsLength * row->scale * (1.f - row->squish) * 1.f / nodes->count();
+                        row.axisEndsLength * row.scale * (1.f - row.squish) * 1.f / nodes->count();
                 }
                 float crossOffset;
                 switch (optsCrossAxisAlign(opts, m_crossLineAlignment)) {
@@ -709,11 +762,11 @@ public:
                     case AxisAlignment::Center:
                     case AxisAlignment::Between:
                     case AxisAlignment::Even: {
-                        crossOffset = row->crossLength / 2 - pos.crossLength * (.5f - pos.crossAnchor);
+                        crossOffset = row.crossLength / 2 - pos.crossLength * (.5f - pos.crossAnchor);
                     } break;
 
                     case AxisAlignment::End: {
-                        crossOffset = row->crossLength - pos.crossLength * (1.f - pos.crossAnchor);
+                        crossOffset = row.crossLength - pos.crossLength * (1.f - pos.crossAnchor);
                     } break;
                 }
                 if (m_axis == Axis::Row) {
@@ -727,16 +780,16 @@ public:
             }
         
             if (m_crossAlignment == AxisAlignment::Even) {
-                rowCrossPos -= rowEvenSpace / 2 - row->crossLength / 2 - 
-                    rowsEndsLength * 1.5f * row->scale * (1.f - columnSquish) * 1.f / rows->count();
+                rowCrossPos -= rowEvenSpace / 2 - row.crossLength / 2 - 
+                    rowsEndsLength * 1.5f * row.scale * (1.f - columnSquish) * 1.f / rows.size();
             }
             else if (m_crossAlignment == AxisAlignment::Between) {
                 rowCrossPos -= rowCrossBetweenSpace -
-                    rowsEndsLength * 1.5f * row->scale * (1.f - columnSquish) * 1.f / rows->count();
+                    rowsEndsLength * 1.5f * row.scale * (1.f - columnSquish) * 1.f / rows.size();
             }
             else {
                 rowCrossPos -= m_gap * columnSquish - 
-                    rowsEndsLength * 1.5f * row->scale * (1.f - columnSquish) * 1.f / rows->count();
+                    rowsEndsLength * 1.5f * row.scale * (1.f - columnSquish) * 1.f / rows.size();
             }
         }
     }
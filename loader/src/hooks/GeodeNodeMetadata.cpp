@@ -2,8 +2,13 @@
 #include <Geode/utils/cocos.hpp>
 #include <Geode/modify/Field.hpp>
 #include <Geode/modify/CCNode.hpp>
+#include <Geode/ui/SpacerNode.hpp>
+#include <Geode/binding/CCMenuItemSpriteExtra.hpp>
 #include <cocos2d.h>
+#include <bit>
+#include <mutex>
 #include <queue>
+#include <shared_mutex>
 
 using namespace geode::prelude;
 using namespace geode::modifier;
@@ -15,15 +20,178 @@ constexpr auto METADATA_TAG = 0xB324ABC;
 
 struct ProxyCCNode;
 
+// Everything an AxisLayout reads when it's applied, flattened into a list of
+// values so that two states can be compared exactly (a hash could collide and
+// silently skip a layout that actually needed to run)
+class LayoutInputs final {
+    std::vector<uint64_t> m_values;
+
+public:
+    template <class T>
+    void add(T value) {
+        if constexpr (std::is_floating_point_v<T>) {
+            m_values.push_back(std::bit_cast<uint32_t>(static_cast<float>(value)));
+        }
+        else if constexpr (std::is_pointer_v<T>) {
+            m_values.push_back(reinterpret_cast<uintptr_t>(value));
+        }
+        else {
+            m_values.push_back(static_cast<uint64_t>(value));
+        }
+    }
+    template <class T>
+    void add(std::optional<T> const& value) {
+        this->add(value.has_value());
+        if (value) {
+            this->add(*value);
+        }
+    }
+    void add(CCSize const& size) {
+        this->add(size.width);
+        this->add(size.height);
+    }
+    void add(CCPoint const& point) {
+        this->add(point.x);
+        this->add(point.y);
+    }
+
+    void clear() {
+        m_values.clear();
+    }
+    bool empty() const {
+        return m_values.empty();
+    }
+    bool operator==(LayoutInputs const& other) const {
+        return m_values == other.m_values;
+    }
+    void swap(LayoutInputs& other) {
+        m_values.swap(other.m_values);
+    }
+};
+
+// A node ID stored once for every node that uses it, so IDs can be compared
+// by pointer. Freed once neither a node nor a parsed query refers to it
+struct NodeIDAtom final {
+    std::string value;
+    // How many live nodes have this ID
+    std::atomic_size_t users = 0;
+    // How many parsed queries look for this ID
+    std::atomic_size_t queries = 0;
+};
+
+class NodeIDTable final {
+    std::shared_mutex m_mutex;
+    std::unordered_map<std::string_view, std::unique_ptr<NodeIDAtom>> m_atoms;
+
+public:
+    using RefCount = std::atomic_size_t NodeIDAtom::*;
+
+    static NodeIDTable& get() {
+        // Intentionally leaked, since nodes may outlive static destruction
+        static auto inst = new NodeIDTable();
+        return *inst;
+    }
+
+    /**
+     * Get the atom for an ID if some node currently has it. The result may
+     * only be compared against, as it can be freed once the lock is released
+     */
+    NodeIDAtom const* findUsed(std::string_view id) {
+        std::shared_lock lock(m_mutex);
+        auto it = m_atoms.find(id);
+        return it != m_atoms.end() && it->second->users > 0 ? it->second.get() : nullptr;
+    }
+
+    /**
+     * Get the atom for an ID, creating it if needed, and count a reference
+     * to it in `refs`. Must be paired with a call to release
+     */
+    NodeIDAtom* acquire(std::string_view id, RefCount refs) {
+        {
+            std::shared_lock lock(m_mutex);
+            if (auto it = m_atoms.find(id); it != m_atoms.end()) {
+                (it->second.get()->*refs) += 1;
+                return it->second.get();
+            }
+        }
+        std::unique_lock lock(m_mutex);
+        auto it = m_atoms.find(id);
+        if (it == m_atoms.end()) {
+            auto atom = std::make_unique<NodeIDAtom>();
+            atom->value = id;
+            // The key views the atom's own string, which never moves
+            it = m_atoms.try_emplace(atom->value, std::move(atom)).first;
+        }
+        (it->second.get()->*refs) += 1;
+        return it->second.get();
+    }
+
+    void release(NodeIDAtom* atom, RefCount refs) {
+        // Counts only ever drop to zero while holding the lock, so that
+        // acquire can't pick up an atom that's being freed
+        auto count = (atom->*refs).load();
+        while (count > 1) {
+            if ((atom->*refs).compare_exchange_weak(count, count - 1)) {
+                return;
+            }
+        }
+        std::unique_lock lock(m_mutex);
+        if (--(atom->*refs) == 0 && atom->users == 0 && atom->queries == 0) {
+            m_atoms.erase(m_atoms.find(atom->value));
+        }
+    }
+};
+
+// Children of a node by ID. Only built for nodes with enough children that a
+// linear scan gets slow, and only once getChildByID is called on them; after
+// that it's kept up to date by the addChild / removeChild / setID hooks
+struct ChildIDIndex final {
+    static constexpr size_t MIN_CHILDREN = 8;
+
+    std::unordered_map<NodeIDAtom const*, std::vector<CCNode*>> children;
+    // What the children array looked like the last time the index was
+    // updated, so that changes made directly to the array are noticed
+    CCArray* array = nullptr;
+    size_t count = 0;
+
+    bool isValidFor(CCNode* node) const {
+        auto nodeChildren = node->getChildren();
+        return array == nodeChildren && count == (nodeChildren ? nodeChildren->count() : 0);
+    }
+    void add(NodeIDAtom const* id, CCNode* child) {
+        if (id) {
+            children[id].push_back(child);
+        }
+    }
+    void remove(NodeIDAtom const* id, CCNode* child) {
+        if (!id) return;
+        auto it = children.find(id);
+        if (it == children.end()) return;
+        std::erase(it->second, child);
+        if (it->second.empty()) {
+            children.erase(it);
+        }
+    }
+};
+
 class GeodeNodeMetadata final : public cocos2d::CCObject {
 private:
+    std::unique_ptr<FieldArena> m_fieldArena;
+    // Fields of mods built against headers from before FieldArena existed
     std::unordered_map<std::string, FieldContainer*> m_classFieldContainers;
-    std::string m_id = "";
+    // nullptr if the node has no ID
+    NodeIDAtom* m_id = nullptr;
+    std::unique_ptr<ChildIDIndex> m_childIndex;
     Ref<Layout> m_layout = nullptr;
     Ref<LayoutOptions> m_layoutOptions = nullptr;
     std::unordered_map<std::string, Ref<CCObject>> m_userObjects;
     std::unordered_set<std::unique_ptr<EventListenerProtocol>> m_eventListeners;
     std::unordered_map<std::string, std::unique_ptr<EventListenerProtocol>> m_idEventListeners;
+    // Inputs of the layout as they were right after it was last applied
+    LayoutInputs m_layoutInputs;
+    size_t m_layoutSuspendCount = 0;
+    bool m_layoutPending = false;
+    bool m_layoutPendingChildOrder = false;
 
     friend class ProxyCCNode;
     friend class cocos2d::CCNode;
@@ -31,12 +199,96 @@ private:
     GeodeNodeMetadata() {}
 
     virtual ~GeodeNodeMetadata() {
+        // Fields go first, since their destructors may still use the node
+        m_fieldArena.reset();
         for (auto& [_, container] : m_classFieldContainers) {
             delete container;
         }
+        if (m_id) {
+            NodeIDTable::get().release(m_id, &NodeIDAtom::users);
+        }
     }
 
 public:
+    // Like set, but doesn't create the metadata if the node has none
+    static GeodeNodeMetadata* get(CCNode* target) {
+        if (!target) return nullptr;
+        auto obj = target->m_pUserObject;
+        if (obj && obj->getTag() == METADATA_TAG) {
+            return static_cast<GeodeNodeMetadata*>(obj);
+        }
+        return nullptr;
+    }
+
+    static NodeIDAtom const* getIDAtom(CCNode* target) {
+        auto meta = get(target);
+        return meta ? meta->m_id : nullptr;
+    }
+
+    // Get the index of this node's children, building it if needed. Returns
+    // nullptr if the node has too few children to be worth indexing
+    ChildIDIndex* getChildIndex(CCNode* self) {
+        auto children = self->getChildren();
+        if (!children || children->count() < ChildIDIndex::MIN_CHILDREN) {
+            m_childIndex.reset();
+            return nullptr;
+        }
+        if (m_childIndex && m_childIndex->isValidFor(self)) {
+            return m_childIndex.get();
+        }
+        m_childIndex = std::make_unique<ChildIDIndex>();
+        for (auto child : CCArrayExt<CCNode*>(children)) {
+            m_childIndex->add(getIDAtom(child), child);
+        }
+        m_childIndex->array = children;
+        m_childIndex->count = children->count();
+        return m_childIndex.get();
+    }
+
+    // Called by the hooks after a child has been added to this node
+    void onChildAdded(CCNode* self, CCNode* child) {
+        if (!m_childIndex) return;
+        // If the array was modified behind our back, rebuild on the next lookup
+        auto children = self->getChildren();
+        if (m_childIndex->array != children || m_childIndex->count + 1 != children->count()) {
+            m_childIndex.reset();
+            return;
+        }
+        m_childIndex->add(getIDAtom(child), child);
+        m_childIndex->count += 1;
+    }
+
+    // Called by the hooks right before a child is removed from this node
+    void onChildRemoving(CCNode* self, CCNode* child) {
+        if (!m_childIndex) return;
+        if (!m_childIndex->isValidFor(self)) {
+            m_childIndex.reset();
+            return;
+        }
+        m_childIndex->remove(getIDAtom(child), child);
+        m_childIndex->count -= 1;
+    }
+
+    void setID(CCNode* self, std::string_view id) {
+        auto& table = NodeIDTable::get();
+        auto atom = id.empty() ? nullptr : table.acquire(id, &NodeIDAtom::users);
+        if (atom == m_id) {
+            if (atom) {
+                table.release(atom, &NodeIDAtom::users);
+            }
+            return;
+        }
+        auto parentMeta = get(self->getParent());
+        if (parentMeta && parentMeta->m_childIndex) {
+            parentMeta->m_childIndex->remove(m_id, self);
+            parentMeta->m_childIndex->add(atom, self);
+        }
+        if (m_id) {
+            table.release(m_id, &NodeIDAtom::users);
+        }
+        m_id = atom;
+    }
+
     static GeodeNodeMetadata* set(CCNode* target) {
         if (!target) return nullptr;
 
@@ -62,6 +314,13 @@ public:
         return meta;
     }
 
+    FieldArena* getFieldArena() {
+        if (!m_fieldArena) {
+            m_fieldArena = std::make_unique<FieldArena>();
+        }
+        return m_fieldArena.get();
+    }
+
     FieldContainer* getFieldContainer(char const* forClass) {
         if (!m_classFieldContainers.count(forClass)) {
             m_classFieldContainers[forClass] = new FieldContainer();
@@ -73,6 +332,31 @@ public:
 // proxy forwards
 #include <Geode/modify/CCNode.hpp>
 struct ProxyCCNode : Modify<ProxyCCNode, CCNode> {
+    // Keep the child ID indices up to date; every other way of adding or
+    // removing a single child goes through these two
+    virtual void addChild(CCNode* child, int zOrder, int tag) {
+        CCNode::addChild(child, zOrder, tag);
+        if (child && child->getParent() == this) {
+            if (auto meta = GeodeNodeMetadata::get(this)) {
+                meta->onChildAdded(this, child);
+            }
+        }
+    }
+    virtual void removeChild(CCNode* child, bool cleanup) {
+        if (child && child->getParent() == this) {
+            if (auto meta = GeodeNodeMetadata::get(this)) {
+                meta->onChildRemoving(this, child);
+            }
+        }
+        CCNode::removeChild(child, cleanup);
+    }
+    virtual void removeAllChildrenWithCleanup(bool cleanup) {
+        if (auto meta = GeodeNodeMetadata::get(this)) {
+            meta->m_childIndex.reset();
+        }
+        CCNode::removeAllChildrenWithCleanup(cleanup);
+    }
+
     virtual CCObject* getUserObject() {
         if (auto asNode = typeinfo_cast<CCNode*>(this)) {
             return asNode->getUserObject("");
@@ -95,9 +379,98 @@ struct ProxyCCNode : Modify<ProxyCCNode, CCNode> {
     }
 };
 
-static inline std::unordered_map<std::string, size_t> s_nextIndex;
+struct FieldArena::Block {
+    size_t classIndex;
+    size_t index;
+    Destructor destructor;
+    void* data;
+    Block* next;
+};
+
+struct FieldArena::Chunk {
+    Chunk* next;
+    size_t size;
+    // followed by the memory of the chunk
+};
+
+FieldArena::FieldArena() : m_cursor(m_inline), m_end(m_inline + INLINE_SIZE) {}
+
+FieldArena::~FieldArena() {
+    for (auto block = m_blocks; block; block = block->next) {
+        if (block->destructor) {
+            block->destructor(block->data);
+        }
+    }
+    while (m_chunks) {
+        auto next = m_chunks->next;
+        operator delete(m_chunks);
+        m_chunks = next;
+    }
+}
+
+void* FieldArena::allocate(size_t size, size_t align) {
+    void* ptr = m_cursor;
+    size_t space = m_end - m_cursor;
+    if (!std::align(align, size, ptr, space)) {
+        // Chunks grow geometrically so nodes with lots of fields don't end
+        // up with lots of small chunks
+        auto chunkSize = std::max(
+            (m_chunks ? m_chunks->size : INLINE_SIZE) * 2,
+            size + align + sizeof(Block) + alignof(Block)
+        );
+        auto chunk = static_cast<Chunk*>(operator new(sizeof(Chunk) + chunkSize));
+        chunk->next = m_chunks;
+        chunk->size = chunkSize;
+        m_chunks = chunk;
+
+        m_cursor = reinterpret_cast<std::byte*>(chunk + 1);
+        m_end = m_cursor + chunkSize;
+        ptr = m_cursor;
+        space = chunkSize;
+        std::align(align, size, ptr, space);
+    }
+    m_cursor = static_cast<std::byte*>(ptr) + size;
+    return ptr;
+}
+
+void* FieldArena::getField(size_t classIndex, size_t index) {
+    for (auto block = m_blocks; block; block = block->next) {
+        if (block->index == index && block->classIndex == classIndex) {
+            return block->data;
+        }
+    }
+    return nullptr;
+}
+
+void* FieldArena::setField(size_t classIndex, size_t index, size_t size, size_t align, Destructor destructor) {
+    auto block = static_cast<Block*>(this->allocate(sizeof(Block), alignof(Block)));
+    auto data = this->allocate(size, align);
+    m_blocks = new (block) Block {
+        .classIndex = classIndex,
+        .index = index,
+        .destructor = destructor,
+        .data = data,
+        .next = m_blocks,
+    };
+    return data;
+}
+
+static std::mutex s_fieldIndexMutex;
+static std::unordered_map<std::string, size_t> s_nextIndex;
+static std::unordered_map<std::string, size_t> s_classIndices;
+
 size_t modifier::getFieldIndexForClass(char const* name) {
-	return s_nextIndex[name]++;
+    std::unique_lock lock(s_fieldIndexMutex);
+    return s_nextIndex[name]++;
+}
+
+size_t modifier::getFieldClassIndex(char const* name) {
+    std::unique_lock lock(s_fieldIndexMutex);
+    return s_classIndices.try_emplace(name, s_classIndices.size()).first->second;
+}
+
+FieldArena* CCNode::getFieldArena() {
+    return GeodeNodeMetadata::set(this)->getFieldArena();
 }
 
 FieldContainer* CCNode::getFieldContainer(char const* forClass) {
@@ -105,73 +478,96 @@ FieldContainer* CCNode::getFieldContainer(char const* forClass) {
 }
 
 const std::string& CCNode::getID() {
-    return GeodeNodeMetadata::set(this)->m_id;
+    static const std::string empty = "";
+    auto id = GeodeNodeMetadata::set(this)->m_id;
+    return id ? id->value : empty;
 }
 
 void CCNode::setID(std::string const& id) {
-    GeodeNodeMetadata::set(this)->m_id = id;
+    GeodeNodeMetadata::set(this)->setID(this, id);
 }
 
 void CCNode::setID(std::string&& id) {
-    GeodeNodeMetadata::set(this)->m_id = std::move(id);
+    GeodeNodeMetadata::set(this)->setID(this, id);
 }
 
-CCNode* CCNode::getChildByID(std::string_view id) {
-    for (auto child : CCArrayExt<CCNode*>(this->getChildren())) {
-        if (child->getID() == id) {
+static CCNode* getChildByIDAtom(CCNode* node, NodeIDAtom const* id) {
+    auto children = node->getChildren();
+    if (!children) {
+        return nullptr;
+    }
+    // Checked here as well so small nodes don't need metadata just for this
+    if (children->count() >= ChildIDIndex::MIN_CHILDREN) {
+        auto index = GeodeNodeMetadata::set(node)->getChildIndex(node);
+        auto it = index->children.find(id);
+        if (it == index->children.end()) {
+            return nullptr;
+        }
+        if (it->second.size() == 1) {
+            return it->second.front();
+        }
+        // Several children share the ID, so fall through to find whichever
+        // comes first in the (possibly since reordered) children array
+    }
+    for (auto child : CCArrayExt<CCNode*>(children)) {
+        if (GeodeNodeMetadata::getIDAtom(child) == id) {
             return child;
         }
     }
     return nullptr;
 }
 
-CCNode* CCNode::getChildByIDRecursive(std::string_view id) {
-    if (auto child = this->getChildByID(id)) {
+static CCNode* getChildByIDAtomRecursive(CCNode* node, NodeIDAtom const* id) {
+    if (auto child = getChildByIDAtom(node, id)) {
         return child;
     }
-    for (auto child : CCArrayExt<CCNode*>(m_pChildren)) {
-        if ((child = child->getChildByIDRecursive(id))) {
+    for (auto child : CCArrayExt<CCNode*>(node->getChildren())) {
+        if ((child = getChildByIDAtomRecursive(child, id))) {
             return child;
         }
     }
     return nullptr;
 }
 
-class BFSNodeTreeCrawler final {
-private:
-    std::queue<CCNode*> m_queue;
-    std::unordered_set<CCNode*> m_explored;
-
-public:
-    BFSNodeTreeCrawler(CCNode* target) {
-        if (auto first = getChild(target, 0)) {
-            m_explored.insert(first);
-            m_queue.push(first);
+CCNode* CCNode::getChildByID(std::string_view id) {
+    if (id.empty()) {
+        for (auto child : CCArrayExt<CCNode*>(this->getChildren())) {
+            if (child->getID().empty()) {
+                return child;
+            }
         }
+        return nullptr;
+    }
+    // If no node currently has this ID there's nothing to look for
+    auto atom = NodeIDTable::get().findUsed(id);
+    if (!atom) {
+        return nullptr;
     }
+    return getChildByIDAtom(this, atom);
+}
 
-    CCNode* next() {
-        if (m_queue.empty()) {
-            return nullptr;
-        }
-        auto node = m_queue.front();
-        m_queue.pop();
-        for (auto sibling : CCArrayExt<CCNode*>(node->getParent()->getChildren())) {
-            if (!m_explored.contains(sibling)) {
-                m_explored.insert(sibling);
-                m_queue.push(sibling);
-            }
+CCNode* CCNode::getChildByIDRecursive(std::string_view id) {
+    if (id.empty()) {
+        if (auto child = this->getChildByID(id)) {
+            return child;
         }
-        for (auto child : CCArrayExt<CCNode*>(node->getChildren())) {
-            if (!m_explored.contains(child)) {
-                m_explored.insert(child);
-                m_queue.push(child);
+        for (auto child : CCArrayExt<CCNode*>(m_pChildren)) {
+            if ((child = child->getChildByIDRecursive(id))) {
+                return child;
             }
         }
-        return node;
+        return nullptr;
     }
-};
+    auto atom = NodeIDTable::get().findUsed(id);
+    if (!atom) {
+        return nullptr;
+    }
+    return getChildByIDAtomRecursive(this, atom);
+}
 
+// A parsed querySelector query, compiled into a flat list of steps whose IDs
+// are interned so matching only compares pointers. Holds a reference to each
+// of its IDs' atoms, so they stay the same even while no node has the ID
 class NodeQuery final {
 private:
     enum class Op {
@@ -179,18 +575,124 @@ private:
         DescendantChild,
     };
 
-    std::string m_targetID;
-    Op m_nextOp;
-    std::unique_ptr<NodeQuery> m_next = nullptr;
+    struct Step {
+        // nullptr for the node the query is run on, which matches anything
+        NodeIDAtom* id = nullptr;
+        // How the node matched by the next step relates to this one
+        Op nextOp = Op::DescendantChild;
+    };
+
+    struct PendingNode {
+        CCNode* node;
+        // Steps matched by this node itself
+        uint64_t matched;
+        // Steps matched by this node or any of its ancestors
+        uint64_t inherited;
+    };
+
+    // Parsed queries by their text; selectors are nearly always literals so
+    // this stays small, but is dropped if something generates lots of them
+    static constexpr size_t MAX_CACHED = 1024;
+
+    struct QueryHash {
+        using is_transparent = void;
+        size_t operator()(std::string_view str) const {
+            return std::hash<std::string_view>()(str);
+        }
+    };
+    static inline std::unordered_map<std::string, std::shared_ptr<NodeQuery const>, QueryHash, std::equal_to<>> s_cache;
+    static inline std::shared_mutex s_cacheMutex;
+
+    // Breadth-first search queues, one per step since a descendant search
+    // for one step runs nested inside the search for the previous one
+    static inline thread_local std::vector<std::vector<CCNode*>> s_queues;
+    static inline thread_local std::vector<PendingNode> s_pending;
+
+    std::vector<Step> m_steps;
+
+    static bool matchesID(Step const& step, CCNode* node) {
+        return !step.id || GeodeNodeMetadata::getIDAtom(node) == step.id;
+    }
+
+    bool canMatch() const {
+        // If nobody has one of the IDs right now, nothing can match
+        for (auto const& step : m_steps) {
+            if (step.id && step.id->users == 0) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    CCNode* matchStep(size_t ix, CCNode* node) const {
+        // Make sure this matches the ID being looked for
+        if (!matchesID(m_steps[ix], node)) {
+            return nullptr;
+        }
+        // If this is the last thing to match, return the result
+        if (ix + 1 == m_steps.size()) {
+            return node;
+        }
+        switch (m_steps[ix].nextOp) {
+            case Op::ImmediateChild: {
+                if (ix + 2 == m_steps.size()) {
+                    return getChildByIDAtom(node, m_steps[ix + 1].id);
+                }
+                for (auto c : CCArrayExt<CCNode*>(node->getChildren())) {
+                    if (auto r = this->matchStep(ix + 1, c)) {
+                        return r;
+                    }
+                }
+            } break;
+
+            case Op::DescendantChild: {
+                auto& queue = s_queues[ix];
+                queue.clear();
+                for (auto c : CCArrayExt<CCNode*>(node->getChildren())) {
+                    queue.push_back(c);
+                }
+                for (size_t head = 0; head < queue.size(); head++) {
+                    auto c = queue[head];
+                    if (auto r = this->matchStep(ix + 1, c)) {
+                        return r;
+                    }
+                    for (auto child : CCArrayExt<CCNode*>(c->getChildren())) {
+                        queue.push_back(child);
+                    }
+                }
+            } break;
+        }
+        return nullptr;
+    }
 
 public:
-    static Result<std::unique_ptr<NodeQuery>> parse(std::string_view query) {
+    // matchAll tracks the steps matched as a bitmask
+    static constexpr size_t MAX_STEPS_FOR_ALL = 64;
+
+    NodeQuery() = default;
+    NodeQuery(NodeQuery const&) = delete;
+    NodeQuery& operator=(NodeQuery const&) = delete;
+
+    ~NodeQuery() {
+        for (auto const& step : m_steps) {
+            if (step.id) {
+                NodeIDTable::get().release(step.id, &NodeIDAtom::queries);
+            }
+        }
+    }
+
+    static Result<std::shared_ptr<NodeQuery const>> parse(std::string_view query) {
         if (query.empty()) {
             return Err("Query may not be empty");
         }
 
-        auto result = std::make_unique<NodeQuery>();
-        NodeQuery* current = result.get();
+        auto result = std::make_shared<NodeQuery>();
+        auto& steps = result->m_steps;
+        steps.emplace_back();
+
+        auto intern = [](std::string const& id) -> NodeIDAtom* {
+            return id.empty() ? nullptr : NodeIDTable::get().acquire(id, &NodeIDAtom::queries);
+        };
 
         size_t i = 0;
         std::string collectedID;
@@ -214,10 +716,9 @@ public:
             // ID-valid characters
             else if (std::isalnum(c) || c == '-' || c == '_' || c == '/' || c == '.') {
                 if (nextOp) {
-                    current->m_next = std::make_unique<NodeQuery>();
-                    current->m_nextOp = *nextOp;
-                    current->m_targetID = collectedID;
-                    current = current->m_next.get();
+                    steps.back().nextOp = *nextOp;
+                    steps.back().id = intern(collectedID);
+                    steps.emplace_back();
 
                     collectedID = "";
                     nextOp = std::nullopt;
@@ -234,56 +735,110 @@ public:
         if (nextOp || collectedID.empty()) {
             return Err("Expected node ID but got end of query");
         }
-        current->m_targetID = collectedID;
+        steps.back().id = intern(collectedID);
+
+        return Ok(std::shared_ptr<NodeQuery const>(std::move(result)));
+    }
 
-        return Ok(std::move(result));
+    /**
+     * Get the parsed query for a query string, parsing it only if it hasn't
+     * been seen before
+     */
+    static Result<std::shared_ptr<NodeQuery const>> get(std::string_view query) {
+        {
+            std::shared_lock lock(s_cacheMutex);
+            auto it = s_cache.find(query);
+            if (it != s_cache.end()) {
+                return Ok(it->second);
+            }
+        }
+        GEODE_UNWRAP_INTO(auto parsed, parse(query));
+        std::unique_lock lock(s_cacheMutex);
+        if (s_cache.size() >= MAX_CACHED) {
+            s_cache.clear();
+        }
+        s_cache.try_emplace(std::string(query), parsed);
+        return Ok(parsed);
+    }
+
+    size_t getStepCount() const {
+        return m_steps.size();
     }
 
     CCNode* match(CCNode* node) const {
-        // Make sure this matches the ID being looked for
-        if (!m_targetID.empty() && node->getID() != m_targetID) {
+        if (!this->canMatch()) {
             return nullptr;
         }
-        // If this is the last thing to match, return the result
-        if (!m_next) {
-            return node;
+        if (s_queues.size() < m_steps.size()) {
+            s_queues.resize(m_steps.size());
         }
-        switch (m_nextOp) {
-            case Op::ImmediateChild: {
-                for (auto c : CCArrayExt<CCNode*>(node->getChildren())) {
-                    if (auto r = m_next->match(c)) {
-                        return r;
-                    }
-                }
-            } break;
+        return this->matchStep(0, node);
+    }
 
-            case Op::DescendantChild: {
-                auto crawler = BFSNodeTreeCrawler(node);
-                while (auto c = crawler.next()) {
-                    if (auto r = m_next->match(c)) {
-                        return r;
+    /**
+     * Collect every node matching the query in a single breadth-first pass,
+     * tracking which steps each node and its ancestors have matched
+     * @note Requires the query to have at most MAX_STEPS_FOR_ALL steps
+     */
+    void matchAll(CCNode* node, std::vector<CCNode*>& out) const {
+        if (!this->canMatch()) {
+            return;
+        }
+        uint64_t immediateSteps = 0;
+        uint64_t descendantSteps = 0;
+        for (size_t i = 0; i + 1 < m_steps.size(); i++) {
+            (m_steps[i].nextOp == Op::ImmediateChild ? immediateSteps : descendantSteps) |= uint64_t(1) << i;
+        }
+        auto const lastStep = uint64_t(1) << (m_steps.size() - 1);
+
+        auto& pending = s_pending;
+        pending.clear();
+        if (matchesID(m_steps[0], node)) {
+            pending.push_back({ node, 1, 1 });
+        }
+        for (size_t head = 0; head < pending.size(); head++) {
+            // Copied since pushing may reallocate
+            auto const parent = pending[head];
+            // Steps whose next step could be matched by a child of this node
+            auto const open = (parent.matched & immediateSteps) | (parent.inherited & descendantSteps);
+            for (auto child : CCArrayExt<CCNode*>(parent.node->getChildren())) {
+                auto const id = GeodeNodeMetadata::getIDAtom(child);
+                uint64_t matched = 0;
+                for (auto steps = open; steps; steps &= steps - 1) {
+                    auto const step = std::countr_zero(steps);
+                    if (m_steps[step + 1].id == id) {
+                        matched |= uint64_t(1) << (step + 1);
                     }
                 }
-            } break;
+                if (matched & lastStep) {
+                    out.push_back(child);
+                }
+                auto const inherited = parent.inherited | matched;
+                // Skip subtrees where no step can make progress anymore
+                if ((inherited & descendantSteps) || (matched & immediateSteps)) {
+                    pending.push_back({ child, matched, inherited });
+                }
+            }
         }
-        return nullptr;
     }
 
     std::string toString() const {
-        auto str = m_targetID.empty() ? "&" : m_targetID;
-        if (m_next) {
-            switch (m_nextOp) {
-                case Op::ImmediateChild: str += " > "; break;
-                case Op::DescendantChild: str += " "; break;
+        std::string str;
+        for (size_t i = 0; i < m_steps.size(); i++) {
+            str += m_steps[i].id ? m_steps[i].id->value : "&";
+            if (i + 1 < m_steps.size()) {
+                switch (m_steps[i].nextOp) {
+                    case Op::ImmediateChild: str += " > "; break;
+                    case Op::DescendantChild: str += " "; break;
+                }
             }
-            str += m_next->toString();
         }
         return str;
     }
 };
 
 CCNode* CCNode::querySelector(std::string_view queryStr) {
-    auto res = NodeQuery::parse(queryStr);
+    auto res = NodeQuery::get(queryStr);
     if (!res) {
         log::error("Invalid CCNode::querySelector query '{}': {}", queryStr, res.unwrapErr());
         return nullptr;
@@ -293,6 +848,25 @@ CCNode* CCNode::querySelector(std::string_view queryStr) {
     return query->match(this);
 }
 
+std::vector<CCNode*> CCNode::querySelectorAll(std::string_view queryStr) {
+    auto res = NodeQuery::get(queryStr);
+    if (!res) {
+        log::error("Invalid CCNode::querySelectorAll query '{}': {}", queryStr, res.unwrapErr());
+        return {};
+    }
+    auto query = std::move(res.unwrap());
+    if (query->getStepCount() > NodeQuery::MAX_STEPS_FOR_ALL) {
+        log::error(
+            "Invalid CCNode::querySelectorAll query '{}': queries may have at most {} parts",
+            queryStr, NodeQuery::MAX_STEPS_FOR_ALL - 1
+        );
+        return {};
+    }
+    std::vector<CCNode*> result;
+    query->matchAll(this, result);
+    return result;
+}
+
 void CCNode::removeChildByID(std::string_view id) {
     if (auto child = this->getChildByID(id)) {
         this->removeChild(child);
@@ -306,7 +880,9 @@ void CCNode::setLayout(Layout* layout, bool apply, bool respectAnchor) {
         }
         this->ignoreAnchorPointForPosition(false);
     }
-    GeodeNodeMetadata::set(this)->m_layout = layout;
+    auto meta = GeodeNodeMetadata::set(this);
+    meta->m_layout = layout;
+    meta->m_layoutInputs.clear();
     if (apply) {
         this->updateLayout();
     }
@@ -327,13 +903,131 @@ LayoutOptions* CCNode::getLayoutOptions() {
     return GeodeNodeMetadata::set(this)->m_layoutOptions.data();
 }
 
+// Only the built-in axis layouts are cached, since their inputs are all known;
+// a custom layout could depend on anything
+static AxisLayout* cacheableLayout(Layout* layout) {
+    auto& type = typeid(*layout);
+    if (type == typeid(AxisLayout) || type == typeid(RowLayout) || type == typeid(ColumnLayout)) {
+        return static_cast<AxisLayout*>(layout);
+    }
+    return nullptr;
+}
+
+static void collectLayoutInputs(CCNode* node, AxisLayout* layout, LayoutInputs& inputs) {
+    inputs.clear();
+    inputs.add(layout);
+    inputs.add(layout->getAxis());
+    inputs.add(layout->getAxisAlignment());
+    inputs.add(layout->getCrossAxisAlignment());
+    inputs.add(layout->getCrossAxisLineAlignment());
+    inputs.add(layout->getGap());
+    inputs.add(layout->getAxisReverse());
+    inputs.add(layout->getCrossAxisReverse());
+    inputs.add(layout->getCrossAxisOverflow());
+    inputs.add(layout->getAutoScale());
+    inputs.add(layout->getGrowCrossAxis());
+    inputs.add(layout->getAutoGrowAxis());
+    inputs.add(layout->getDefaultMinScale());
+    inputs.add(layout->getDefaultMaxScale());
+    inputs.add(layout->isIgnoreInvisibleChildren());
+
+    inputs.add(node->getContentSize());
+    inputs.add(node->getScaleX());
+    inputs.add(node->getScaleY());
+
+    for (auto child : CCArrayExt<CCNode*>(node->getChildren())) {
+        inputs.add(child);
+        inputs.add(child->isVisible());
+        inputs.add(child->getContentSize());
+        inputs.add(child->getScaleX());
+        inputs.add(child->getScaleY());
+        inputs.add(child->getPosition());
+        inputs.add(child->getAnchorPoint());
+        inputs.add(child->isIgnoreAnchorPointForPosition());
+
+        auto options = child->getLayoutOptions();
+        inputs.add(options);
+        if (auto opts = typeinfo_cast<AxisLayoutOptions*>(options)) {
+            inputs.add(opts->getAutoScale());
+            inputs.add(opts->hasExplicitMinScale());
+            inputs.add(opts->getMinScale());
+            inputs.add(opts->hasExplicitMaxScale());
+            inputs.add(opts->getMaxScale());
+            inputs.add(opts->getRelativeScale());
+            inputs.add(opts->getLength());
+            inputs.add(opts->getPrevGap());
+            inputs.add(opts->getNextGap());
+            inputs.add(opts->getBreakLine());
+            inputs.add(opts->getSameLine());
+            inputs.add(opts->getScalePriority());
+            inputs.add(opts->getCrossAxisAlignment());
+        }
+        if (auto spacer = typeinfo_cast<SpacerNode*>(child)) {
+            inputs.add(spacer->getGrow());
+        }
+        if (auto btn = typeinfo_cast<CCMenuItemSpriteExtra*>(child)) {
+            inputs.add(btn->m_baseScale);
+        }
+    }
+}
+
 void CCNode::updateLayout(bool updateChildOrder) {
+    auto meta = GeodeNodeMetadata::set(this);
+    if (meta->m_layoutSuspendCount > 0) {
+        meta->m_layoutPending = true;
+        meta->m_layoutPendingChildOrder |= updateChildOrder;
+        return;
+    }
     if (updateChildOrder) {
         this->sortAllChildren();
     }
-    if (auto layout = GeodeNodeMetadata::set(this)->m_layout.data()) {
+    auto layout = meta->m_layout.data();
+    if (!layout) {
+        return;
+    }
+    auto axisLayout = cacheableLayout(layout);
+    if (!axisLayout) {
         layout->apply(this);
+        return;
+    }
+
+    // Layouts are only ever applied on the main thread, so the scratch
+    // buffer can be shared
+    static LayoutInputs current;
+    collectLayoutInputs(this, axisLayout, current);
+    if (!meta->m_layoutInputs.empty() && current == meta->m_layoutInputs) {
+        return;
+    }
+    layout->apply(this);
+    // Store the state after applying, so calling updateLayout again right
+    // away is a no-op while moving or resizing any child isn't
+    collectLayoutInputs(this, axisLayout, current);
+    meta->m_layoutInputs.swap(current);
+}
+
+void CCNode::suspendLayout() {
+    GeodeNodeMetadata::set(this)->m_layoutSuspendCount += 1;
+}
+
+void CCNode::resumeLayout(bool apply) {
+    auto meta = GeodeNodeMetadata::set(this);
+    if (meta->m_layoutSuspendCount == 0) {
+        log::warn("CCNode::resumeLayout called on a node whose layout isn't suspended");
+        return;
     }
+    meta->m_layoutSuspendCount -= 1;
+    if (meta->m_layoutSuspendCount == 0 && meta->m_layoutPending) {
+        auto childOrder = meta->m_layoutPendingChildOrder;
+        meta->m_layoutPending = false;
+        meta->m_layoutPendingChildOrder = false;
+        if (apply) {
+            this->updateLayout(childOrder);
+        }
+    }
+}
+
+bool CCNode::isLayoutSuspended() {
+    return GeodeNodeMetadata::set(this)->m_layoutSuspendCount > 0;
 }
 
 UserObjectSetEvent::UserObjectSetEvent(CCNode* node, std::string const& id, CCObject* value)
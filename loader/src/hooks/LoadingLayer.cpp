@@ -33,6 +33,11 @@ struct CustomLoadingLayer : Modify<CustomLoadingLayer, LoadingLayer> {
         });
         auto str = fmt::format("Geode: Loaded {}/{} mods", count, m_fields->m_totalMods);
         this->setSmallText(str);
+        auto [unzipped, toUnzip] = LoaderImpl::get()->getUnzipProgress();
+        if (unzipped < toUnzip) {
+            this->setSmallText2(fmt::format("Unzipping {}/{}", unzipped, toUnzip));
+            return;
+        }
         auto currentMod = LoaderImpl::get()->m_currentlyLoadingMod;
         auto modName = currentMod ? currentMod->getName() : "Unknown";
         this->setSmallText2(modName);
@@ -2,6 +2,7 @@
 #include <fmt/core.h>
 #include "about.hpp"
 #include "../loader/ModImpl.hpp"
+#include "../loader/LogImpl.hpp"
 #include <Geode/Utils.hpp>
 
 using namespace geode::prelude;
@@ -60,6 +61,9 @@ std::string crashlog::writeCrashlog(geode::Mod* faultyMod, std::string const& in
 }
 
 std::string crashlog::writeCrashlog(geode::Mod* faultyMod, std::string const& info, std::string const& stacktrace, std::string const& registers, std::filesystem::path& outPath) {
+    // get whatever logs are still queued onto disk before anything else
+    log::Logger::get()->flush();
+
     // make sure crashlog directory exists
     (void)utils::file::createDirectoryAll(crashlog::getCrashLogDirectory());
 
@@ -100,6 +104,14 @@ std::string crashlog::writeCrashlog(geode::Mod* faultyMod, std::string const& in
     file << "\n== Installed Mods ==\n";
     printMods(file);
 
+    // the last few warnings and errors often explain what led up to the crash
+    file << "\n== Recent Warnings and Errors ==\n";
+    log::LogQuery query;
+    query.minSeverity = Severity::Warning;
+    for (auto const& log : log::Logger::get()->query(query, 20)) {
+        file << log.toString() << "\n";
+    }
+
     // save actual file
     outPath = crashlog::getCrashLogDirectory() / (getDateString(true) + ".log");
     std::ofstream actualFile;
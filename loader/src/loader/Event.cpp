@@ -1,16 +1,62 @@
 #include <Geode/loader/Event.hpp>
 #include <Geode/utils/ranges.hpp>
+#include <algorithm>
 #include <mutex>
 
 using namespace geode::prelude;
 
+// Event checks set through EventListenerProtocol::setEventCheck. These are 
+// kept here rather than in the listener so its layout stays the same for mods 
+// built against older headers
+namespace {
+    struct EventChecks {
+        std::mutex mutex;
+        std::unordered_map<EventListenerProtocol const*, bool(*)(Event*)> checks;
+
+        static EventChecks& get() {
+            static EventChecks inst;
+            return inst;
+        }
+    };
+}
+
 DefaultEventListenerPool::DefaultEventListenerPool() : m_data(new Data) {}
 
+void DefaultEventListenerPool::Data::insert(EventListenerProtocol* listener) {
+    auto type = &typeid(*listener);
+    auto it = m_groupIndices.find(type);
+    if (it == m_groupIndices.end()) {
+        it = m_groupIndices.insert({ type, m_groups.size() }).first;
+        m_groups.emplace_back();
+    }
+    auto& group = m_groups[it->second];
+    if (!group.check) {
+        auto& checks = EventChecks::get();
+        std::unique_lock lock(checks.mutex);
+        if (auto check = checks.checks.find(listener); check != checks.checks.end()) {
+            group.check = check->second;
+        }
+    }
+    group.listeners.push_back({ listener, m_nextOrder++ });
+    m_listenerGroups.insert({ listener, it->second });
+}
+
+DefaultEventListenerPool::Data::Bucket& DefaultEventListenerPool::Data::bucketFor(Event* event) {
+    auto& bucket = m_buckets[&typeid(*event)];
+    for (; bucket.seenGroups < m_groups.size(); bucket.seenGroups++) {
+        auto check = m_groups[bucket.seenGroups].check;
+        if (!check || check(event)) {
+            bucket.groups.push_back(bucket.seenGroups);
+        }
+    }
+    return bucket;
+}
+
 bool DefaultEventListenerPool::add(EventListenerProtocol* listener) {
     if (!m_data) m_data = std::make_unique<Data>();
 
     std::unique_lock lock(m_data->m_mutex);
-    if (ranges::contains(m_data->m_listeners, listener) || ranges::contains(m_data->m_toAdd, listener)) {
+    if (m_data->m_listenerGroups.contains(listener) || ranges::contains(m_data->m_toAdd, listener)) {
         return false;
     }
     
@@ -18,8 +64,7 @@ bool DefaultEventListenerPool::add(EventListenerProtocol* listener) {
         m_data->m_toAdd.push_back(listener);
     }
     else {
-        // insert listeners at the start so new listeners get priority
-        m_data->m_listeners.push_front(listener);
+        m_data->insert(listener);
     }
     return true;
 }
@@ -28,17 +73,27 @@ void DefaultEventListenerPool::remove(EventListenerProtocol* listener) {
     if (!m_data) m_data = std::make_unique<Data>();
 
     std::unique_lock lock(m_data->m_mutex);
+    ranges::remove(m_data->m_toAdd, listener);
+
+    auto it = m_data->m_listenerGroups.find(listener);
+    if (it == m_data->m_listenerGroups.end()) {
+        return;
+    }
+    auto& group = m_data->m_groups[it->second];
+    m_data->m_listenerGroups.erase(it);
     if (m_data->m_locked) {
-        for (size_t i = 0 ; i < m_data->m_listeners.size(); i++) {
-            if (m_data->m_listeners[i] == listener) {
-                m_data->m_listeners[i] = nullptr;
+        for (auto& entry : group.listeners) {
+            if (entry.listener == listener) {
+                entry.listener = nullptr;
             }
         }
+        group.hasRemoved = true;
     }
     else {
-        ranges::remove(m_data->m_listeners, listener);
+        std::erase_if(group.listeners, [&](auto const& entry) {
+            return entry.listener == listener;
+        });
     }
-    ranges::remove(m_data->m_toAdd, listener);
 }
 
 ListenerResult DefaultEventListenerPool::handle(Event* event) {
@@ -47,22 +102,57 @@ ListenerResult DefaultEventListenerPool::handle(Event* event) {
     auto res = ListenerResult::Propagate;
     m_data->m_locked += 1;
     std::unique_lock lock(m_data->m_mutex);
-    for (auto h : m_data->m_listeners) {
+
+    // Listeners are only nulled out rather than removed while locked, so
+    // positions stay valid even across recursive posts
+    auto notify = [&](size_t group, size_t index) {
+        auto h = m_data->m_groups[group].listeners[index].listener;
         lock.unlock();
         if (h && h->handle(event) == ListenerResult::Stop) {
             res = ListenerResult::Stop;
-            lock.lock();
-            break;
         }
         lock.lock();
+        return res == ListenerResult::Stop;
+    };
+
+    auto const& groups = m_data->bucketFor(event).groups;
+    if (groups.size() == 1) {
+        auto const group = groups.front();
+        for (size_t i = m_data->m_groups[group].listeners.size(); i > 0; i--) {
+            if (notify(group, i - 1)) break;
+        }
+    }
+    else if (groups.size() > 1) {
+        // Rare case of an event accepted by different kinds of listeners,
+        // which still have to be called newest first
+        std::vector<std::pair<size_t, size_t>> order;
+        for (auto group : groups) {
+            for (size_t i = 0; i < m_data->m_groups[group].listeners.size(); i++) {
+                order.push_back({ group, i });
+            }
+        }
+        std::sort(order.begin(), order.end(), [&](auto const& a, auto const& b) {
+            return m_data->m_groups[a.first].listeners[a.second].order >
+                m_data->m_groups[b.first].listeners[b.second].order;
+        });
+        for (auto [group, index] : order) {
+            if (notify(group, index)) break;
+        }
     }
     m_data->m_locked -= 1;
     // only mutate listeners once nothing is iterating 
     // (if there are recursive handle calls)
     if (m_data->m_locked == 0) {
-        ranges::remove(m_data->m_listeners, nullptr);
+        for (auto& group : m_data->m_groups) {
+            if (group.hasRemoved) {
+                std::erase_if(group.listeners, [](auto const& entry) {
+                    return entry.listener == nullptr;
+                });
+                group.hasRemoved = false;
+            }
+        }
         for (auto listener : m_data->m_toAdd) {
-            m_data->m_listeners.push_front(listener);
+            m_data->insert(listener);
         }
         m_data->m_toAdd.clear();
     }
@@ -103,6 +193,15 @@ void EventListenerProtocol::disable() {
 
 EventListenerProtocol::~EventListenerProtocol() {
     this->disable();
+    auto& checks = EventChecks::get();
+    std::unique_lock lock(checks.mutex);
+    checks.checks.erase(this);
+}
+
+void EventListenerProtocol::setEventCheck(bool(*check)(Event*)) {
+    auto& checks = EventChecks::get();
+    std::unique_lock lock(checks.mutex);
+    checks.checks[this] = check;
 }
 
 Event::~Event() {}
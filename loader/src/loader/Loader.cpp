@@ -100,6 +100,18 @@ void Loader::queueInMainThread(ScheduledFunction&& func) {
     return m_impl->queueInMainThread(std::forward<ScheduledFunction>(func));
 }
 
+void Loader::queueInMainThread(ScheduledFunction&& func, MainThreadPriority priority) {
+    return m_impl->queueInMainThread(std::forward<ScheduledFunction>(func), priority);
+}
+
+void Loader::setMainThreadQueueBudget(std::optional<std::chrono::microseconds> budget) {
+    return m_impl->m_mainThreadQueue.setBudget(budget);
+}
+
+MainThreadQueueStats Loader::getMainThreadQueueStats() const {
+    return m_impl->m_mainThreadQueue.getStats();
+}
+
 std::string Loader::getGameVersion() {
     return m_impl->getGameVersion();
 }
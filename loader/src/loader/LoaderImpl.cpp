@@ -18,6 +18,8 @@
 #include <Geode/utils/string.hpp>
 #include <Geode/utils/web.hpp>
 #include <about.hpp>
+#include <algorithm>
+#include <atomic>
 #include <crashlog.hpp>
 #include <fmt/format.h>
 #include <hash.hpp>
@@ -30,6 +32,7 @@
 #include <vector>
 
 #include <server/DownloadManager.hpp>
+#include <utils/WebCache.hpp>
 #include <Geode/ui/Popup.hpp>
 
 using namespace geode::prelude;
@@ -68,6 +71,7 @@ void Loader::Impl::createDirectories() {
     (void) utils::file::createDirectoryAll(dirs::getGeodeLogDir());
     (void) utils::file::createDirectoryAll(dirs::getTempDir());
     (void) utils::file::createDirectoryAll(dirs::getModRuntimeDir());
+    (void) utils::file::createDirectoryAll(dirs::getIndexDir());
 
     if (!ranges::contains(m_modSearchDirectories, dirs::getModsDir())) {
         m_modSearchDirectories.push_back(dirs::getModsDir());
@@ -265,48 +269,135 @@ void Loader::Impl::addProblem(LoadProblem const& problem) {
 // Dependencies and refreshing
 
 void Loader::Impl::queueMods(std::vector<ModMetadata>& modQueue) {
+    auto begin = std::chrono::high_resolution_clock::now();
+
+    m_metadataIndex.load();
+
+    // Collect the packages first so the queue keeps directory order no matter
+    // which worker finishes parsing first
+    struct Package {
+        std::filesystem::path path;
+        std::optional<ModMetadataIndex::Stamp> stamp;
+        std::optional<Result<ModMetadata>> result;
+        bool cached = false;
+    };
+    std::vector<Package> packages;
     for (auto const& dir : m_modSearchDirectories) {
         log::debug("Searching {}", dir);
-        log::NestScope nest;
         for (auto const& entry : std::filesystem::directory_iterator(dir)) {
             if (!std::filesystem::is_regular_file(entry) ||
                 entry.path().extension() != GEODE_MOD_EXTENSION)
                 continue;
+            packages.push_back({ .path = entry.path() });
+        }
+    }
 
-            log::debug("Found {}", entry.path().filename());
-            log::NestScope nest;
+    auto discovered = std::chrono::high_resolution_clock::now();
 
-            auto res = ModMetadata::createFromGeodeFile(entry.path());
-            if (!res) {
-                this->addProblem({
-                    LoadProblem::Type::InvalidFile,
-                    entry.path(),
-                    res.unwrapErr()
-                });
-                log::error("Failed to queue: {}", res.unwrapErr());
-                continue;
+    // Opening the zip and parsing mod.json doesn't touch any loader state, so
+    // it can be fanned out; everything that does (problems, duplicates,
+    // logging) happens afterwards on this thread. Packages that haven't
+    // changed since they were last indexed aren't opened at all
+    {
+        std::atomic_size_t next = 0;
+        auto worker = [&]() {
+            for (auto i = next++; i < packages.size(); i = next++) {
+                auto& package = packages[i];
+                package.stamp = ModMetadataIndex::getStamp(package.path);
+                if (package.stamp) {
+                    if (auto metadata = m_metadataIndex.find(package.path, *package.stamp)) {
+                        package.result.emplace(Ok(std::move(*metadata)));
+                        package.cached = true;
+                        continue;
+                    }
+                }
+                package.result.emplace(ModMetadata::createFromGeodeFile(package.path));
             }
-            auto modMetadata = res.unwrap();
+        };
 
-            log::debug("id: {}", modMetadata.getID());
-            log::debug("version: {}", modMetadata.getVersion());
-            log::debug("early: {}", modMetadata.needsEarlyLoad() ? "yes" : "no");
+        auto workerCount = std::clamp<size_t>(
+            std::thread::hardware_concurrency(), 1, MAX_MOD_DISCOVERY_THREADS
+        );
+        workerCount = std::min(workerCount, packages.size());
 
-            if (std::find_if(modQueue.begin(), modQueue.end(), [&](auto& item) {
-                    return modMetadata.getID() == item.getID();
-                }) != modQueue.end()) {
-                this->addProblem({
-                    LoadProblem::Type::Duplicate,
-                    modMetadata,
-                    "A mod with the same ID is already present."
-                });
-                log::error("Failed to queue: a mod with the same ID is already queued");
-                continue;
-            }
+        std::vector<std::thread> workers;
+        for (size_t i = 1; i < workerCount; i++) {
+            workers.emplace_back([&]() {
+                thread::setName("Mod Discovery");
+                worker();
+            });
+        }
+        worker();
+        for (auto& workerThread : workers) {
+            workerThread.join();
+        }
+    }
+
+    auto parsed = std::chrono::high_resolution_clock::now();
+
+    size_t cachedCount = 0;
+    std::vector<std::filesystem::path> packagePaths;
+    for (auto& package : packages) {
+        auto const& path = package.path;
+        auto& res = package.result.value();
+        packagePaths.push_back(path);
+
+        log::debug("Found {}", path.filename());
+        log::NestScope nest;
+
+        if (!res) {
+            this->addProblem({
+                LoadProblem::Type::InvalidFile,
+                path,
+                res.unwrapErr()
+            });
+            log::error("Failed to queue: {}", res.unwrapErr());
+            continue;
+        }
+        auto modMetadata = res.unwrap();
+
+        if (package.cached) {
+            cachedCount += 1;
+        }
+        else if (package.stamp) {
+            m_metadataIndex.insert(modMetadata, *package.stamp);
+        }
 
-            modQueue.push_back(modMetadata);
+        log::debug("id: {}", modMetadata.getID());
+        log::debug("version: {}", modMetadata.getVersion());
+        log::debug("early: {}", modMetadata.needsEarlyLoad() ? "yes" : "no");
+
+        if (std::find_if(modQueue.begin(), modQueue.end(), [&](auto& item) {
+                return modMetadata.getID() == item.getID();
+            }) != modQueue.end()) {
+            this->addProblem({
+                LoadProblem::Type::Duplicate,
+                modMetadata,
+                "A mod with the same ID is already present."
+            });
+            log::error("Failed to queue: a mod with the same ID is already queued");
+            continue;
         }
+
+        modQueue.push_back(std::move(modMetadata));
+    }
+
+    m_metadataIndex.retain(packagePaths);
+    if (auto res = m_metadataIndex.save(); !res) {
+        log::warn("Unable to save mod metadata index: {}", res.unwrapErr());
     }
+
+    auto end = std::chrono::high_resolution_clock::now();
+    auto seconds = [](auto from, auto to) {
+        return static_cast<float>(
+            std::chrono::duration_cast<std::chrono::milliseconds>(to - from).count()
+        ) / 1000.f;
+    };
+    log::info(
+        "Queued {} of {} packages ({} cached) in {}s (search {}s, parse {}s, queue {}s)",
+        modQueue.size(), packages.size(), cachedCount, seconds(begin, end),
+        seconds(begin, discovered), seconds(discovered, parsed), seconds(parsed, end)
+    );
 }
 
 void Loader::Impl::populateModList(std::vector<ModMetadata>& modQueue) {
@@ -425,13 +516,6 @@ void Loader::Impl::loadModGraph(Mod* node, bool early) {
     m_refreshedModCount += 1;
     m_lateRefreshedModCount += early ? 0 : 1;
 
-    auto unzipFunction = [this, node]() {
-        log::debug("Unzip");
-        log::NestScope nest;
-        auto res = node->m_impl->unzipGeodeFile(node->getMetadata());
-        return res;
-    };
-
     auto loadFunction = [this, node, early]() {
         if (node->shouldLoad()) {
             log::debug("Load");
@@ -465,47 +549,114 @@ void Loader::Impl::loadModGraph(Mod* node, bool early) {
         }
     }
 
-    if (early) {
-        auto res = unzipFunction();
-        if (!res) {
-            this->addProblem({
-                LoadProblem::Type::UnzipFailed,
-                node,
-                res.unwrapErr()
-            });
-            log::error("Failed to unzip: {}", res.unwrapErr());
-            m_refreshingModCount -= 1;
-            return;
+    // Late mods have already been unzipped in the background by
+    // startUnzippingMods, early mods are unzipped right here
+    auto res = early ? this->unzipMod(node) : this->takeModUnzipResult(node);
+    if (!res) {
+        this->addProblem({
+            LoadProblem::Type::UnzipFailed,
+            node,
+            res.unwrapErr()
+        });
+        log::error("Failed to unzip: {}", res.unwrapErr());
+        m_refreshingModCount -= 1;
+        return;
+    }
+    loadFunction();
+}
+
+Result<> Loader::Impl::unzipMod(Mod* mod) {
+    log::debug("Unzip {}", mod->getID());
+    log::NestScope nest;
+    return mod->m_impl->unzipGeodeFile(mod->getMetadata());
+}
+
+void Loader::Impl::startUnzippingMods() {
+    std::unique_lock lock(m_unzipMutex);
+    for (auto mod : m_modsToLoad) {
+        // Don't bother unzipping mods that loadModGraph is going to reject
+        // regardless of load order
+        auto const& metadata = mod->getMetadata();
+        if (
+            !metadata.checkGameVersion() ||
+            !metadata.checkGeodeVersion() ||
+            metadata.m_impl->m_softInvalidReason
+        ) {
+            continue;
         }
-        loadFunction();
+        m_unzipQueue.push_back(mod);
+        m_unzipPending.insert(mod);
     }
-    else {
-        auto nest = log::saveNest();
-        std::thread([=, this]() {
+    m_unzipModTotal = m_unzipQueue.size();
+    m_unzippedModCount = 0;
+
+    auto workerCount = std::clamp<size_t>(
+        std::thread::hardware_concurrency(), 1, MAX_MOD_UNZIP_THREADS
+    );
+    workerCount = std::min(workerCount, m_unzipQueue.size());
+    lock.unlock();
+
+    log::debug("Unzipping {} mods on {} threads", m_unzipModTotal, workerCount);
+
+    auto nest = log::saveNest();
+    for (size_t i = 0; i < workerCount; i++) {
+        std::thread([this, nest]() {
             thread::setName("Mod Unzip");
             log::loadNest(nest);
-            auto res = unzipFunction();
-            this->queueInMainThread([=, this, res = std::move(res)]() {
-                auto prevNest = log::saveNest();
-                log::loadNest(nest);
-                if (!res) {
-                    this->addProblem({
-                        LoadProblem::Type::UnzipFailed,
-                        node,
-                        res.unwrapErr()
-                    });
-                    log::error("Failed to unzip: {}", res.unwrapErr());
-                    m_refreshingModCount -= 1;
-                    log::loadNest(prevNest);
-                    return;
+            while (true) {
+                Mod* mod;
+                {
+                    std::lock_guard lock(m_unzipMutex);
+                    if (m_unzipQueue.empty()) {
+                        return;
+                    }
+                    mod = m_unzipQueue.front();
+                    m_unzipQueue.pop_front();
                 }
-                loadFunction();
-                log::loadNest(prevNest);
-            });
+                auto res = this->unzipMod(mod);
+                {
+                    std::lock_guard lock(m_unzipMutex);
+                    m_unzipPending.erase(mod);
+                    m_unzipResults.emplace(mod, std::move(res));
+                }
+                m_unzippedModCount += 1;
+                this->queueInMainThread([this]() {
+                    this->onModUnzipped();
+                });
+            }
         }).detach();
     }
 }
 
+bool Loader::Impl::isModUnzipPending(Mod* mod) const {
+    std::lock_guard lock(m_unzipMutex);
+    return m_unzipPending.contains(mod);
+}
+
+Result<> Loader::Impl::takeModUnzipResult(Mod* mod) {
+    {
+        std::lock_guard lock(m_unzipMutex);
+        if (auto node = m_unzipResults.extract(mod)) {
+            return std::move(node.mapped());
+        }
+    }
+    // The mod wasn't scheduled, which only happens if it failed the checks
+    // in startUnzippingMods but somehow passed them in loadModGraph
+    return this->unzipMod(mod);
+}
+
+std::pair<int, int> Loader::Impl::getUnzipProgress() const {
+    return { m_unzippedModCount.load(), m_unzipModTotal };
+}
+
+void Loader::Impl::onModUnzipped() {
+    // Otherwise loading is already queued for the next frame, or done
+    if (m_waitingForUnzip) {
+        m_waitingForUnzip = false;
+        this->continueRefreshModGraph();
+    }
+}
+
 void Loader::Impl::findProblems() {
     for (auto const& [id, mod] : m_mods) {
         if (!mod->shouldLoad()) {
@@ -700,10 +851,17 @@ void Loader::Impl::refreshModGraph() {
         }
     }
 
+    log::debug("Unzipping mods");
+    {
+        log::NestScope nest;
+        this->startUnzippingMods();
+    }
+
     auto end = std::chrono::high_resolution_clock::now();
     auto time = std::chrono::duration_cast<std::chrono::milliseconds>(end - begin).count();
     log::info("Took {}s. Continuing next frame...", static_cast<float>(time) / 1000.f);
 
+    m_timerBegin = std::chrono::high_resolution_clock::now();
     m_loadingState = LoadingState::Mods;
 
     queueInMainThread([this]() {
@@ -759,36 +917,40 @@ void Loader::Impl::orderModStack() {
 }
 
 void Loader::Impl::continueRefreshModGraph() {
-    if (m_refreshingModCount != 0) {
-        queueInMainThread([this]() {
-            this->continueRefreshModGraph();
-        });
-        return;
-    }
-
-    if  (m_lateRefreshedModCount > 0) {
-        auto end = std::chrono::high_resolution_clock::now();
-        auto time = std::chrono::duration_cast<std::chrono::milliseconds>(end - m_timerBegin).count();
-        log::info("Took {}s", static_cast<float>(time) / 1000.f);
-    }
-
-    log::info("Continuing mod graph refresh...");
-    log::NestScope nest;
-
-    m_timerBegin = std::chrono::high_resolution_clock::now();
-
     switch (m_loadingState) {
-        case LoadingState::Mods:
-            if (!m_modsToLoad.empty()) {
+        case LoadingState::Mods: {
+            // Binaries still have to be loaded in dependency order, so stop at
+            // the first mod that's still being unzipped; its worker calls
+            // back into here through onModUnzipped once it's done. Otherwise
+            // load as many mods as fit in the budget and continue next frame
+            auto batchBegin = std::chrono::steady_clock::now();
+            while (!m_modsToLoad.empty()) {
                 auto mod = m_modsToLoad.front();
+                if (this->isModUnzipPending(mod)) {
+                    m_waitingForUnzip = true;
+                    return;
+                }
+                if (std::chrono::steady_clock::now() - batchBegin >= LATE_MOD_LOAD_BUDGET) {
+                    queueInMainThread([this]() {
+                        this->continueRefreshModGraph();
+                    });
+                    return;
+                }
                 m_modsToLoad.pop_front();
                 log::debug("Loading mod {} {}", mod->getID(), mod->getVersion());
                 this->loadModGraph(mod, false);
-                break;
+            }
+            if (m_lateRefreshedModCount > 0) {
+                auto end = std::chrono::high_resolution_clock::now();
+                auto time = std::chrono::duration_cast<std::chrono::milliseconds>(end - m_timerBegin).count();
+                log::info("Loaded {} late mods in {}s", m_lateRefreshedModCount, static_cast<float>(time) / 1000.f);
             }
             m_loadingState = LoadingState::Problems;
             [[fallthrough]];
+        }
         case LoadingState::Problems:
+            log::info("Continuing mod graph refresh...");
+            m_timerBegin = std::chrono::high_resolution_clock::now();
             log::debug("Finding problems");
             {
                 log::NestScope nest;
@@ -807,12 +969,6 @@ void Loader::Impl::continueRefreshModGraph() {
                 "Was Loader::Impl::continueRefreshModGraph() called from the wrong place?");
             break;
     }
-
-    if (m_loadingState != LoadingState::Done) {
-        queueInMainThread([this]() {
-            this->continueRefreshModGraph();
-        });
-    }
 }
 
 std::vector<LoadProblem> Loader::Impl::getProblems() const {
@@ -825,8 +981,10 @@ void Loader::Impl::forceReset() {
     }
     m_mods.clear();
     log::Logger::get()->clear();
+    m_metadataIndex.clear();
     std::filesystem::remove_all(dirs::getModRuntimeDir());
     std::filesystem::remove_all(dirs::getTempDir());
+    web::WebCache::get().clear();
 }
 
 bool Loader::Impl::isReadyToHook() const {
@@ -851,23 +1009,12 @@ bool Loader::Impl::loadHooks() {
     return !hadErrors;
 }
 
-void Loader::Impl::queueInMainThread(ScheduledFunction&& func) {
-    std::lock_guard<std::mutex> lock(m_mainThreadMutex);
-    m_mainThreadQueue.push_back(std::forward<ScheduledFunction>(func));
+void Loader::Impl::queueInMainThread(ScheduledFunction&& func, MainThreadPriority priority) {
+    m_mainThreadQueue.push(std::forward<ScheduledFunction>(func), priority);
 }
 
 void Loader::Impl::executeMainThreadQueue() {
-    // copy queue to avoid locking mutex if someone is
-    // running addToMainThread inside their function
-    m_mainThreadMutex.lock();
-    auto queue = m_mainThreadQueue;
-    m_mainThreadQueue.clear();
-    m_mainThreadMutex.unlock();
-
-    // call queue
-    for (auto const& func : queue) {
-        func();
-    }
+    m_mainThreadQueue.execute();
 }
 
 void Loader::Impl::provideNextMod(Mod* mod) {
@@ -10,8 +10,12 @@
 #include <Geode/Result.hpp>
 #include <Geode/utils/map.hpp>
 #include <Geode/utils/ranges.hpp>
+#include "MainThreadQueue.hpp"
 #include "ModImpl.hpp"
+#include "ModMetadataIndex.hpp"
 #include <crashlog.hpp>
+#include <atomic>
+#include <chrono>
 #include <mutex>
 #include <optional>
 #include <thread>
@@ -23,6 +27,13 @@
 
 namespace geode {
     static constexpr std::string_view LAUNCH_ARG_PREFIX = "--geode:";
+    // Upper bound on threads used to open & parse .geode packages at startup
+    static constexpr size_t MAX_MOD_DISCOVERY_THREADS = 8;
+    // Upper bound on threads used to unzip late-loaded mods
+    static constexpr size_t MAX_MOD_UNZIP_THREADS = 4;
+    // How long the main thread may spend loading late mods each frame, so the
+    // loading screen keeps updating
+    static constexpr auto LATE_MOD_LOAD_BUDGET = std::chrono::milliseconds(8);
 
     class Loader::Impl {
     public:
@@ -36,12 +47,12 @@ namespace geode {
         std::unordered_map<std::string, Mod*> m_mods;
         std::deque<Mod*> m_modsToLoad;
         std::vector<std::filesystem::path> m_texturePaths;
+        ModMetadataIndex m_metadataIndex;
         bool m_isSetup = false;
 
         LoadingState m_loadingState = LoadingState::None;
 
-        std::vector<std::function<void(void)>> m_mainThreadQueue;
-        mutable std::mutex m_mainThreadMutex;
+        MainThreadQueue m_mainThreadQueue;
         std::vector<std::pair<Hook*, Mod*>> m_uninitializedHooks;
         bool m_readyToHook = false;
 
@@ -57,6 +68,18 @@ namespace geode {
         int m_refreshedModCount = 0;
         int m_lateRefreshedModCount = 0;
 
+        // Late mods are unzipped by a pool of workers while the main thread
+        // loads their binaries in order as soon as each one is ready
+        mutable std::mutex m_unzipMutex;
+        std::deque<Mod*> m_unzipQueue;
+        std::unordered_set<Mod*> m_unzipPending;
+        std::unordered_map<Mod*, Result<>> m_unzipResults;
+        std::atomic_int m_unzippedModCount = 0;
+        int m_unzipModTotal = 0;
+        // Set when loading stopped at a mod that's still being unzipped, so
+        // that the next finished unzip continues it
+        bool m_waitingForUnzip = false;
+
         std::unordered_map<std::string, std::string> m_launchArgs;
 
         std::chrono::time_point<std::chrono::high_resolution_clock> m_timerBegin;
@@ -100,6 +123,13 @@ namespace geode {
         void buildModGraph();
         void orderModStack();
         void loadModGraph(Mod* node, bool early);
+        Result<> unzipMod(Mod* mod);
+        void startUnzippingMods();
+        bool isModUnzipPending(Mod* mod) const;
+        Result<> takeModUnzipResult(Mod* mod);
+        void onModUnzipped();
+        // Returns (unzipped, total) for the late mods being unzipped
+        std::pair<int, int> getUnzipProgress() const;
         void findProblems();
         void refreshModGraph();
         void continueRefreshModGraph();
@@ -121,7 +151,7 @@ namespace geode {
 
         void updateResources(bool forceReload);
 
-        void queueInMainThread(ScheduledFunction&& func);
+        void queueInMainThread(ScheduledFunction&& func, MainThreadPriority priority = MainThreadPriority::Normal);
         void executeMainThreadQueue();
 
         bool isReadyToHook() const;
@@ -4,12 +4,15 @@
 #include <Geode/loader/Dirs.hpp>
 #include <Geode/loader/Log.hpp>
 #include <Geode/loader/Mod.hpp>
+#include <Geode/loader/ModEvent.hpp>
 #include <Geode/utils/casts.hpp>
 #include <Geode/utils/general.hpp>
 #include <fmt/chrono.h>
 #include <fmt/format.h>
+#include <algorithm>
 #include <iomanip>
 #include <memory>
+#include <thread>
 #include <utility>
 
 using namespace geode::prelude;
@@ -107,14 +110,14 @@ void log::vlogImpl(Severity sev, Mod* mod, fmt::string_view format, fmt::format_
 }
 
 
-Log::Log(Severity sev, std::string&& thread, std::string&& source, int32_t nestCount,
+Log::Log(Severity sev, std::string_view thread, std::string_view source, int32_t nestCount,
     std::string&& content) :
     m_time(log_clock::now()),
     m_severity(sev),
     m_thread(thread),
     m_source(source),
     m_nestCount(nestCount),
-    m_content(content) {}
+    m_content(std::move(content)) {}
 
 Log::~Log() = default;
 
@@ -148,8 +151,8 @@ std::string Log::toString() const {
     }
 
     auto nestCount = m_nestCount;
-    auto source = m_source;
-    auto thread = m_thread;
+    auto source = std::string(m_source);
+    auto thread = std::string(m_thread);
 
     if (nestCount != 0) {
         nestCount -= static_cast<int32_t>(source.size() + thread.size());
@@ -204,45 +207,261 @@ Severity Log::getSeverity() const {
     return m_severity;
 }
 
+log_clock::time_point Log::getTime() const {
+    return m_time;
+}
+
+std::string_view Log::getThread() const {
+    return m_thread;
+}
+
+std::string_view Log::getSource() const {
+    return m_source;
+}
+
+std::string const& Log::getContent() const {
+    return m_content;
+}
+
+bool LogQuery::matches(Log const& log) const {
+    if (log.getSeverity().m_value < minSeverity.m_value) {
+        return false;
+    }
+    if (source && log.getSource() != *source) {
+        return false;
+    }
+    if (since && log.getTime() < *since) {
+        return false;
+    }
+    if (until && log.getTime() > *until) {
+        return false;
+    }
+    return true;
+}
+
 // Logger
 
+Logger::Logger() : m_queue(std::make_unique<Slot[]>(QUEUE_CAPACITY)) {
+    for (size_t i = 0; i < QUEUE_CAPACITY; i++) {
+        m_queue[i].sequence.store(i, std::memory_order_relaxed);
+    }
+}
+
 Logger* Logger::get() {
-    static Logger inst;
-    return &inst;
+    // Intentionally leaked, as the writer thread may still be running while
+    // static objects are destroyed at exit
+    static auto inst = new Logger();
+    return inst;
 }
 
 void Logger::setup() {
     m_logStream = std::ofstream(dirs::getGeodeLogDir() / log::generateLogName());
+
+    std::thread(&Logger::writerLoop, this).detach();
+    m_writerRunning = true;
+    std::atexit(+[] {
+        Logger::get()->flush();
+    });
+}
+
+std::string_view Logger::intern(std::string_view str) {
+    {
+        std::shared_lock lock(m_internMutex);
+        if (auto it = m_interned.find(str); it != m_interned.end()) {
+            return *it;
+        }
+    }
+    std::unique_lock lock(m_internMutex);
+    return *m_interned.emplace(str).first;
+}
+
+void Logger::addToHistory(Log&& log) {
+    std::lock_guard g(m_historyMutex);
+    if (m_historyCapacity == 0) {
+        return;
+    }
+    if (m_history.size() < m_historyCapacity) {
+        m_history.push_back(std::move(log));
+    }
+    else {
+        m_history[m_historyStart] = std::move(log);
+        m_historyStart = (m_historyStart + 1) % m_history.size();
+    }
+}
+
+// Bounded multi-producer queue based on Dmitry Vyukov's design; only ever
+// consumed by one thread at a time through m_writeMutex
+bool Logger::tryEnqueue(Log&& log) {
+    auto pos = m_enqueuePos.load(std::memory_order_relaxed);
+    while (true) {
+        auto& slot = m_queue[pos & (QUEUE_CAPACITY - 1)];
+        auto seq = slot.sequence.load(std::memory_order_acquire);
+        auto diff = static_cast<intptr_t>(seq) - static_cast<intptr_t>(pos);
+        if (diff == 0) {
+            if (m_enqueuePos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+                slot.log.emplace(std::move(log));
+                slot.sequence.store(pos + 1, std::memory_order_release);
+                return true;
+            }
+        }
+        else if (diff < 0) {
+            // The queue is full
+            return false;
+        }
+        else {
+            pos = m_enqueuePos.load(std::memory_order_relaxed);
+        }
+    }
 }
 
-std::mutex& getLogMutex() {
-    static std::mutex mutex;
-    return mutex;
+std::optional<Log> Logger::dequeue() {
+    auto& slot = m_queue[m_dequeuePos & (QUEUE_CAPACITY - 1)];
+    auto seq = slot.sequence.load(std::memory_order_acquire);
+    if (static_cast<intptr_t>(seq) - static_cast<intptr_t>(m_dequeuePos + 1) < 0) {
+        return std::nullopt;
+    }
+    auto log = std::move(slot.log);
+    slot.log.reset();
+    slot.sequence.store(m_dequeuePos + QUEUE_CAPACITY, std::memory_order_release);
+    m_dequeuePos += 1;
+    return log;
+}
+
+void Logger::drain() {
+    bool wrote = false;
+    while (auto log = this->dequeue()) {
+        auto const logStr = log->toString();
+        console::log(logStr, log->getSeverity());
+        m_logStream << logStr << '\n';
+        wrote = true;
+
+        this->addToHistory(std::move(*log));
+    }
+    // Flushing once per batch rather than once per line is what keeps
+    // log-heavy frames cheap
+    if (wrote) {
+        m_logStream.flush();
+    }
+}
+
+void Logger::writerLoop() {
+    thread::setName("Log Writer");
+    while (true) {
+        {
+            // Wakeups can be missed since producers don't take the lock,
+            // so the timeout doubles as the periodic flush
+            std::unique_lock lock(m_wakeMutex);
+            m_wake.wait_for(lock, std::chrono::milliseconds(250), [this] {
+                return m_pending.load();
+            });
+        }
+        m_pending = false;
+
+        std::unique_lock lock(m_writeMutex);
+        this->drain();
+    }
 }
 
 void Logger::push(Severity sev, std::string&& thread, std::string&& source, int32_t nestCount,
     std::string&& content) {
-    std::lock_guard g(getLogMutex());
+    auto log = Log(sev, this->intern(thread), this->intern(source), nestCount, std::move(content));
 
-    Log& log = m_logs.emplace_back(sev, std::move(thread), std::move(source), nestCount,
-            std::move(content));
+    // Logs from before the writer has started are written right away
+    if (!m_writerRunning) {
+        std::unique_lock lock(m_writeMutex);
+        while (!this->tryEnqueue(std::move(log))) {
+            this->drain();
+        }
+        this->drain();
+        return;
+    }
 
-    auto const logStr = log.toString();
-    console::log(logStr, log.getSeverity());
-    m_logStream << logStr << std::endl;
+    while (!this->tryEnqueue(std::move(log))) {
+        m_wake.notify_one();
+        std::this_thread::yield();
+    }
+    if (!m_pending.exchange(true)) {
+        m_wake.notify_one();
+    }
+}
+
+void Logger::flush() {
+    std::unique_lock lock(m_writeMutex, std::defer_lock);
+    if (lock.try_lock_for(std::chrono::seconds(1))) {
+        this->drain();
+    }
 }
 
 Nest::Nest(std::shared_ptr<Nest::Impl> impl) : m_impl(std::move(impl)) { }
 Nest::Impl::Impl(int32_t nestLevel, int32_t nestCountOffset) :
     m_nestLevel(nestLevel), m_nestCountOffset(nestCountOffset) { }
 
-std::vector<Log> const& Logger::list() {
-    return m_logs;
+void Logger::setHistoryCapacity(size_t capacity) {
+    std::lock_guard g(m_historyMutex);
+    if (m_history.size() > capacity) {
+        std::vector<Log> history;
+        history.reserve(capacity);
+        auto const skip = m_history.size() - capacity;
+        for (size_t i = skip; i < m_history.size(); i++) {
+            history.push_back(std::move(m_history[(m_historyStart + i) % m_history.size()]));
+        }
+        m_history = std::move(history);
+    }
+    else if (m_historyStart != 0) {
+        std::rotate(m_history.begin(), m_history.begin() + m_historyStart, m_history.end());
+    }
+    m_historyStart = 0;
+    m_historyCapacity = capacity;
+}
+
+size_t Logger::getHistoryCapacity() const {
+    return m_historyCapacity;
+}
+
+void Logger::forEach(LogQuery const& query, std::function<void(Log const&)> visitor) {
+    std::lock_guard g(m_historyMutex);
+    for (size_t i = 0; i < m_history.size(); i++) {
+        auto const& log = m_history[(m_historyStart + i) % m_history.size()];
+        if (query.matches(log)) {
+            visitor(log);
+        }
+    }
+}
+
+std::vector<Log> Logger::query(LogQuery const& query, size_t limit) {
+    std::vector<Log> res;
+    // This is also used while writing crashlogs, where whichever thread
+    // crashed may have been holding the lock
+    std::unique_lock lock(m_historyMutex, std::defer_lock);
+    if (!lock.try_lock_for(std::chrono::seconds(1))) {
+        return res;
+    }
+    // Walk backwards so a limited query doesn't have to look at the whole
+    // history
+    for (size_t i = m_history.size(); i > 0; i--) {
+        auto const& log = m_history[(m_historyStart + i - 1) % m_history.size()];
+        if (query.matches(log)) {
+            res.push_back(log);
+            if (limit != 0 && res.size() >= limit) {
+                break;
+            }
+        }
+    }
+    std::reverse(res.begin(), res.end());
+    return res;
 }
 
 void Logger::clear() {
-    std::lock_guard g(getLogMutex());
-    m_logs.clear();
+    std::lock_guard g(m_historyMutex);
+    m_history.clear();
+    m_historyStart = 0;
+}
+
+$on_mod(Loaded) {
+    Logger::get()->setHistoryCapacity(Mod::get()->getSettingValue<int64_t>("log-history-size"));
+    listenForSettingChanges<int64_t>("log-history-size", +[](int64_t size) {
+        Logger::get()->setHistoryCapacity(static_cast<size_t>(size));
+    });
 }
 
 // Misc
@@ -3,44 +3,149 @@
 #include <Geode/DefaultInclude.hpp>
 #include <Geode/loader/Log.hpp>
 #include <Geode/loader/Mod.hpp>
+#include <atomic>
+#include <condition_variable>
 #include <vector>
 #include <fstream>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <shared_mutex>
 #include <string>
+#include <string_view>
+#include <unordered_set>
 
 namespace geode::log {
     class Log final {
         log_clock::time_point m_time;
         Severity m_severity;
-        std::string m_thread;
-        std::string m_source;
+        // Interned by the Logger, so these stay valid for the whole session
+        std::string_view m_thread;
+        std::string_view m_source;
         int32_t m_nestCount;
         std::string m_content;
 
     public:
         ~Log();
-        Log(Severity sev, std::string&& thread, std::string&& source, int32_t nestCount,
+        Log(Severity sev, std::string_view thread, std::string_view source, int32_t nestCount,
             std::string&& content);
+        Log(Log const&) = default;
+        Log(Log&&) = default;
+        Log& operator=(Log const&) = default;
+        Log& operator=(Log&&) = default;
 
         [[nodiscard]] std::string toString() const;
 
         [[nodiscard]] Severity getSeverity() const;
+        [[nodiscard]] log_clock::time_point getTime() const;
+        [[nodiscard]] std::string_view getThread() const;
+        [[nodiscard]] std::string_view getSource() const;
+        [[nodiscard]] std::string const& getContent() const;
+    };
+
+    /**
+     * Filter for looking up logs from the history. Unset fields match
+     * everything
+     */
+    struct LogQuery final {
+        // Name of the mod the log came from
+        std::optional<std::string> source;
+        Severity minSeverity = Severity::Debug;
+        std::optional<log_clock::time_point> since;
+        std::optional<log_clock::time_point> until;
+
+        bool matches(Log const& log) const;
     };
 
     class Logger {
     private:
-        std::vector<Log> m_logs;
+        // Must be a power of two
+        static constexpr size_t QUEUE_CAPACITY = 4096;
+
+        // Slot in the lock-free queue of logs waiting to be written; the
+        // sequence number tells producers and the writer whose turn it is
+        struct Slot {
+            std::atomic_size_t sequence;
+            std::optional<Log> log;
+        };
+
+        // Ring buffer of the most recent logs; m_historyStart is the index
+        // of the oldest one once the buffer has filled up
+        std::vector<Log> m_history;
+        std::timed_mutex m_historyMutex;
+        size_t m_historyStart = 0;
+        size_t m_historyCapacity = DEFAULT_HISTORY_CAPACITY;
         std::ofstream m_logStream;
 
-        Logger() = default;
+        // Thread and mod names, which are few but repeated on every log
+        struct InternHash {
+            using is_transparent = void;
+            size_t operator()(std::string_view str) const {
+                return std::hash<std::string_view>()(str);
+            }
+        };
+        std::unordered_set<std::string, InternHash, std::equal_to<>> m_interned;
+        std::shared_mutex m_internMutex;
+
+        std::unique_ptr<Slot[]> m_queue;
+        std::atomic_size_t m_enqueuePos = 0;
+        // Only touched by whoever holds m_writeMutex
+        size_t m_dequeuePos = 0;
+        std::timed_mutex m_writeMutex;
+        std::mutex m_wakeMutex;
+        std::condition_variable m_wake;
+        std::atomic_bool m_pending = false;
+        std::atomic_bool m_writerRunning = false;
+
+        Logger();
+
+        std::string_view intern(std::string_view str);
+        void addToHistory(Log&& log);
+
+        bool tryEnqueue(Log&& log);
+        std::optional<Log> dequeue();
+        void drain();
+        void writerLoop();
+
     public:
+        static constexpr size_t DEFAULT_HISTORY_CAPACITY = 10000;
+
         static Logger* get();
 
         void setup();
 
+        /**
+         * Queue a log to be written by the log writer thread. Only blocks if
+         * the writer has fallen so far behind that the queue is full
+         */
         void push(Severity sev, std::string&& thread, std::string&& source, int32_t nestCount,
             std::string&& content);
+        /**
+         * Synchronously write out every queued log. Used on shutdown and when
+         * crashing, so gives up if the writer doesn't finish within a second
+         */
+        void flush();
+
+        /**
+         * Set how many logs are kept in memory. The oldest logs are dropped
+         * if the history is already larger than this
+         */
+        void setHistoryCapacity(size_t capacity);
+        size_t getHistoryCapacity() const;
 
-        std::vector<Log> const& list();
+        /**
+         * Visit every log in the history matching the query, from oldest to
+         * newest. The history is locked while this runs, so the visitor must
+         * not log anything itself
+         */
+        void forEach(LogQuery const& query, std::function<void(Log const&)> visitor);
+        /**
+         * Copy the logs matching the query, from oldest to newest
+         * @param limit If non-zero, only the newest `limit` matches are returned
+         * @returns An empty vector if the history stays locked for over a second
+         */
+        std::vector<Log> query(LogQuery const& query, size_t limit = 0);
         void clear();
     };
 
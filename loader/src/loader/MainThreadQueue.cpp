@@ -0,0 +1,107 @@
+#include "MainThreadQueue.hpp"
+
+using namespace geode::prelude;
+
+MainThreadQueue::Lane::Lane() : m_head(&m_stub), m_tail(&m_stub) {}
+
+MainThreadQueue::Lane::~Lane() {
+    while (this->pop()) {}
+}
+
+void MainThreadQueue::Lane::pushNode(Node* node) {
+    node->next.store(nullptr, std::memory_order_relaxed);
+    auto prev = m_head.exchange(node, std::memory_order_acq_rel);
+    prev->next.store(node, std::memory_order_release);
+}
+
+void MainThreadQueue::Lane::push(ScheduledFunction&& func) {
+    auto node = new Node();
+    node->func = std::move(func);
+    m_size += 1;
+    this->pushNode(node);
+}
+
+std::optional<ScheduledFunction> MainThreadQueue::Lane::pop() {
+    auto tail = m_tail;
+    auto next = tail->next.load(std::memory_order_acquire);
+    if (tail == &m_stub) {
+        if (!next) {
+            return std::nullopt;
+        }
+        m_tail = next;
+        tail = next;
+        next = next->next.load(std::memory_order_acquire);
+    }
+    if (!next) {
+        // Either tail is the last node, or a producer is halfway through
+        // pushing; in the latter case the node shows up on the next drain
+        if (tail != m_head.load(std::memory_order_acquire)) {
+            return std::nullopt;
+        }
+        this->pushNode(&m_stub);
+        next = tail->next.load(std::memory_order_acquire);
+        if (!next) {
+            return std::nullopt;
+        }
+    }
+    m_tail = next;
+    auto func = std::move(tail->func);
+    delete tail;
+    m_size -= 1;
+    return func;
+}
+
+void MainThreadQueue::push(ScheduledFunction&& func, MainThreadPriority priority) {
+    m_lanes[static_cast<size_t>(priority)].push(std::move(func));
+}
+
+void MainThreadQueue::execute() {
+    using Clock = std::chrono::steady_clock;
+
+    auto const start = Clock::now();
+    auto const budget = m_budget.load();
+    bool deferred = false;
+
+    for (size_t i = LANE_COUNT; i > 0; i--) {
+        auto& lane = m_lanes[i - 1];
+        bool const budgeted = i - 1 != static_cast<size_t>(MainThreadPriority::High) && budget >= 0;
+
+        // Functions queued while draining always wait for the next frame,
+        // so a function that requeues itself can't stall the frame
+        auto count = lane.m_size.load();
+        for (size_t ran = 0; ran < count; ran++) {
+            // Every lane gets to run at least one function per frame
+            if (budgeted && ran > 0) {
+                auto elapsed = std::chrono::duration_cast<std::chrono::microseconds>(Clock::now() - start);
+                if (elapsed.count() >= budget) {
+                    deferred = true;
+                    break;
+                }
+            }
+            auto func = lane.pop();
+            if (!func) break;
+            (*func)();
+            m_stats.executed += 1;
+        }
+    }
+
+    auto time = std::chrono::duration_cast<std::chrono::microseconds>(Clock::now() - start);
+    m_stats.lastDrainTime = time;
+    m_stats.maxDrainTime = std::max(m_stats.maxDrainTime, time);
+    if (deferred) {
+        m_stats.deferredFrames += 1;
+    }
+}
+
+void MainThreadQueue::setBudget(std::optional<std::chrono::microseconds> budget) {
+    m_budget = budget ? budget->count() : -1;
+}
+
+MainThreadQueueStats MainThreadQueue::getStats() const {
+    auto stats = m_stats;
+    stats.backlog = 0;
+    for (auto const& lane : m_lanes) {
+        stats.backlog += lane.m_size.load();
+    }
+    return stats;
+}
@@ -0,0 +1,58 @@
+#pragma once
+
+#include <Geode/loader/Loader.hpp>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <optional>
+
+namespace geode {
+    /**
+     * Queue of functions to run on the main thread. Any thread may push
+     * without taking a lock; only the main thread drains. If a time budget
+     * has been set, draining stops once it's used up for the frame, and
+     * whatever is left runs on the next frame
+     */
+    class MainThreadQueue final {
+    private:
+        struct Node {
+            std::atomic<Node*> next = nullptr;
+            ScheduledFunction func;
+        };
+
+        // Intrusive multi-producer single-consumer list based on Dmitry
+        // Vyukov's design; the stub node keeps producers and the consumer
+        // from ever touching the same pointer
+        class Lane final {
+            std::atomic<Node*> m_head;
+            Node* m_tail;
+            Node m_stub;
+
+            void pushNode(Node* node);
+
+        public:
+            std::atomic_size_t m_size = 0;
+
+            Lane();
+            ~Lane();
+
+            void push(ScheduledFunction&& func);
+            // Main thread only
+            std::optional<ScheduledFunction> pop();
+        };
+
+        static constexpr size_t LANE_COUNT = 3;
+
+        std::array<Lane, LANE_COUNT> m_lanes;
+        // In microseconds, or -1 to always run everything
+        std::atomic<int64_t> m_budget = -1;
+        MainThreadQueueStats m_stats;
+
+    public:
+        void push(ScheduledFunction&& func, MainThreadPriority priority);
+        void execute();
+
+        void setBudget(std::optional<std::chrono::microseconds> budget);
+        MainThreadQueueStats getStats() const;
+    };
+}
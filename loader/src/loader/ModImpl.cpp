@@ -602,8 +602,18 @@ Result<> Mod::Impl::unzipGeodeFile(ModMetadata metadata) {
     }
     log::debug("Hash mismatch detected, unzipping");
 
+    // Without a manifest there's no telling what's in the directory, so
+    // start from scratch
+    auto manifestPath = tempDir / "unzip-manifest.json";
     std::error_code ec;
-    std::filesystem::remove_all(tempDir, ec);
+    if (!std::filesystem::exists(manifestPath)) {
+        std::filesystem::remove_all(tempDir, ec);
+    }
+    else {
+        // Only written back after a successful extraction, so a crash while
+        // extracting forces this to run again
+        std::filesystem::remove(datePath, ec);
+    }
     if (ec) {
         auto message = ec.message();
         #ifdef GEODE_IS_WINDOWS
@@ -620,20 +630,18 @@ Result<> Mod::Impl::unzipGeodeFile(ModMetadata metadata) {
         return Err("Unable to delete temp dir: " + message);
     }
 
-    (void)utils::file::createDirectoryAll(tempDir);
-    auto res = file::writeString(datePath, modifiedHash);
-    if (!res) {
-        log::warn("Failed to write modified date of geode zip: {}", res.unwrapErr());
-    }
-
-
     GEODE_UNWRAP_INTO(auto unzip, file::Unzip::create(metadata.getPath()));
     if (!unzip.hasEntry(metadata.getBinaryName())) {
         return Err(
             fmt::format("Unable to find platform binary under the name \"{}\"", metadata.getBinaryName())
         );
     }
-    GEODE_UNWRAP(unzip.extractAllTo(tempDir));
+    GEODE_UNWRAP(unzip.extractAllToIncremental(tempDir, manifestPath));
+
+    auto res = file::writeString(datePath, modifiedHash);
+    if (!res) {
+        log::warn("Failed to write modified date of geode zip: {}", res.unwrapErr());
+    }
 
     return Ok();
 }
@@ -0,0 +1,159 @@
+#include "ModMetadataIndex.hpp"
+#include "ModMetadataImpl.hpp"
+
+#include <Geode/loader/Dirs.hpp>
+#include <Geode/loader/Log.hpp>
+#include <Geode/utils/JsonValidation.hpp>
+#include <Geode/utils/file.hpp>
+#include <unordered_set>
+
+using namespace geode::prelude;
+
+// Bump whenever the layout of the index file changes
+static constexpr int INDEX_FORMAT_VERSION = 1;
+
+std::filesystem::path ModMetadataIndex::getPath() {
+    return dirs::getIndexDir() / "mod-metadata.json";
+}
+
+std::optional<ModMetadataIndex::Stamp> ModMetadataIndex::getStamp(std::filesystem::path const& path) {
+    std::error_code ec;
+    auto size = std::filesystem::file_size(path, ec);
+    if (ec) return std::nullopt;
+    auto modifiedDate = std::filesystem::last_write_time(path, ec);
+    if (ec) return std::nullopt;
+    auto modifiedCount = std::chrono::duration_cast<std::chrono::milliseconds>(modifiedDate.time_since_epoch());
+    return Stamp {
+        .size = static_cast<int64_t>(size),
+        .modifiedAt = static_cast<int64_t>(modifiedCount.count()),
+    };
+}
+
+void ModMetadataIndex::load() {
+    m_entries.clear();
+    m_dirty = false;
+
+    if (!std::filesystem::exists(getPath())) {
+        return;
+    }
+    auto json = file::readJson(getPath());
+    if (!json) {
+        log::warn("Unable to read mod metadata index: {}", json.unwrapErr());
+        m_dirty = true;
+        return;
+    }
+
+    auto root = checkJson(json.unwrap(), "[mod-metadata.json]");
+    if (root.has("version").get<int>() != INDEX_FORMAT_VERSION) {
+        log::debug("Mod metadata index is outdated, rebuilding");
+        m_dirty = true;
+        return;
+    }
+    for (auto& [path, value] : root.needs("packages").properties()) {
+        Entry entry;
+        value.needs("size").into(entry.stamp.size);
+        value.needs("modified-at").into(entry.stamp.modifiedAt);
+        value.needs("mod.json").assertIsObject().into(entry.json);
+        for (auto& [file, data] : value.has("special-files").properties()) {
+            entry.specialFiles.insert({ file, data.get<std::string>() });
+        }
+        m_entries.insert({ path, std::move(entry) });
+    }
+    if (auto ok = root.ok(); !ok) {
+        log::warn("Mod metadata index is invalid, rebuilding: {}", ok.unwrapErr());
+        m_entries.clear();
+        m_dirty = true;
+    }
+}
+
+Result<> ModMetadataIndex::save() {
+    if (!m_dirty) {
+        return Ok();
+    }
+
+    auto packages = matjson::Value::object();
+    for (auto const& [path, entry] : m_entries) {
+        auto specialFiles = matjson::Value::object();
+        for (auto const& [file, data] : entry.specialFiles) {
+            specialFiles[file] = data;
+        }
+        packages[path] = matjson::makeObject({
+            { "size", entry.stamp.size },
+            { "modified-at", entry.stamp.modifiedAt },
+            { "mod.json", entry.json },
+            { "special-files", specialFiles },
+        });
+    }
+    auto json = matjson::makeObject({
+        { "version", INDEX_FORMAT_VERSION },
+        { "packages", packages },
+    });
+
+    (void)file::createDirectoryAll(getPath().parent_path());
+    GEODE_UNWRAP(file::writeString(getPath(), json.dump(matjson::NO_INDENTATION)));
+    m_dirty = false;
+    return Ok();
+}
+
+void ModMetadataIndex::clear() {
+    m_entries.clear();
+    m_dirty = false;
+    std::error_code ec;
+    std::filesystem::remove(getPath(), ec);
+}
+
+std::optional<ModMetadata> ModMetadataIndex::find(
+    std::filesystem::path const& path, Stamp const& stamp
+) const {
+    auto it = m_entries.find(path.string());
+    if (it == m_entries.end() || it->second.stamp != stamp) {
+        return std::nullopt;
+    }
+    auto const& entry = it->second;
+
+    // The JSON is validated again rather than stored pre-parsed, so a loader
+    // update that changes validation rules applies to cached packages too
+    auto res = ModMetadata::create(entry.json);
+    if (!res) {
+        return std::nullopt;
+    }
+    auto metadata = res.unwrap();
+    auto& impl = ModMetadataImpl::getImpl(metadata);
+    impl.m_path = path;
+    for (auto& [file, target] : impl.getSpecialFiles()) {
+        if (auto data = entry.specialFiles.find(file); data != entry.specialFiles.end()) {
+            *target = data->second;
+        }
+    }
+    return metadata;
+}
+
+void ModMetadataIndex::insert(ModMetadata const& metadata, Stamp const& stamp) {
+    auto copy = metadata;
+    auto& impl = ModMetadataImpl::getImpl(copy);
+
+    Entry entry;
+    entry.stamp = stamp;
+    entry.json = impl.getRawJSON();
+    for (auto& [file, target] : impl.getSpecialFiles()) {
+        if (*target) {
+            entry.specialFiles.insert({ file, target->value() });
+        }
+    }
+    m_entries.insert_or_assign(metadata.getPath().string(), std::move(entry));
+    m_dirty = true;
+}
+
+void ModMetadataIndex::retain(std::vector<std::filesystem::path> const& paths) {
+    std::unordered_set<std::string> keep;
+    for (auto const& path : paths) {
+        keep.insert(path.string());
+    }
+    std::erase_if(m_entries, [&](auto const& pair) {
+        if (keep.contains(pair.first)) {
+            return false;
+        }
+        m_dirty = true;
+        return true;
+    });
+}
@@ -0,0 +1,57 @@
+#pragma once
+
+#include <Geode/loader/ModMetadata.hpp>
+#include <Geode/Result.hpp>
+#include <matjson.hpp>
+#include <filesystem>
+#include <optional>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace geode {
+    /**
+     * Loader-owned cache of already validated mod metadata, keyed by the
+     * path, size and modification time of each .geode package. This lets
+     * startup skip opening packages that haven't changed since last launch
+     */
+    class ModMetadataIndex final {
+    public:
+        struct Stamp {
+            int64_t size = 0;
+            int64_t modifiedAt = 0;
+
+            bool operator==(Stamp const&) const = default;
+        };
+
+    private:
+        struct Entry {
+            Stamp stamp;
+            matjson::Value json;
+            std::unordered_map<std::string, std::string> specialFiles;
+        };
+
+        std::unordered_map<std::string, Entry> m_entries;
+        bool m_dirty = false;
+
+    public:
+        static std::filesystem::path getPath();
+        static std::optional<Stamp> getStamp(std::filesystem::path const& path);
+
+        void load();
+        Result<> save();
+        void clear();
+
+        /**
+         * Recreate the metadata for a package if it was indexed with the
+         * same stamp. Doesn't modify the index, so this is safe to call
+         * from multiple threads at once
+         */
+        std::optional<ModMetadata> find(std::filesystem::path const& path, Stamp const& stamp) const;
+        void insert(ModMetadata const& metadata, Stamp const& stamp);
+        /**
+         * Drop entries for packages that no longer exist
+         */
+        void retain(std::vector<std::filesystem::path> const& paths);
+    };
+}
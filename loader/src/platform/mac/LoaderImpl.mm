@@ -88,9 +88,9 @@ void console::openIfClosed() {
 
     s_isOpen = true;
 
-    for (auto const& log : log::Logger::get()->list()) {
+    log::Logger::get()->forEach({}, [](log::Log const& log) {
         console::log(log.toString(), log.getSeverity());
-    }
+    });
 }
 
 CFDataRef msgPortCallback(CFMessagePortRef port, SInt32 messageID, CFDataRef data, void* info) {
@@ -32,9 +32,9 @@ void setupConsole(bool forceUseEscapeCodes = false) {
         }
     }
 
-    for (auto const& log : log::Logger::get()->list()) {
+    log::Logger::get()->forEach({}, [](log::Log const& log) {
         console::log(log.toString(), log.getSeverity());
-    }
+    });
 }
 
 struct stdData {
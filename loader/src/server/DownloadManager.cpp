@@ -3,7 +3,6 @@
 #include <Geode/loader/Dirs.hpp>
 #include <Geode/utils/map.hpp>
 #include <optional>
-#include <hash/hash.hpp>
 #include <loader/ModImpl.hpp>
 
 using namespace server;
@@ -28,7 +27,6 @@ public:
     DownloadStatus m_status;
     EventListener<ServerRequest<ServerModVersion>> m_infoListener;
     EventListener<web::WebTask> m_downloadListener;
-    unsigned int m_scheduledEventForFrame = 0;
 
     Impl(
         std::string const& id,
@@ -83,15 +81,13 @@ public:
                 m_infoListener.setFilter(ServerRequest<ServerModVersion>());
             }
 
+            // No throttling needed here, as a Task posts at most one progress 
+            // event per main-thread queue drain (the same goes for the 
+            // download listener below)
             if (!ModDownloadManager::get()->checkAutoConfirm()) {
-                // Throttle events to only once per frame to not cause a 
-                // billion UI updates at once 
-                if (m_scheduledEventForFrame != CCDirector::get()->getTotalFrames()) {
-                    m_scheduledEventForFrame = CCDirector::get()->getTotalFrames();
-                    Loader::get()->queueInMainThread([id = m_id]() {
-                        ModDownloadEvent(id).post();
-                    });
-                }
+                Loader::get()->queueInMainThread([id = m_id]() {
+                    ModDownloadEvent(id).post();
+                });
             }
         });
         auto fetchVersion = version.has_value() ? ModVersion(*version) : ModVersion(ModVersionLatest());
@@ -110,11 +106,15 @@ public:
             .percentage = 0,
         };
 
-        m_downloadListener.bind([this, hash = version.hash, version = version](web::WebTask::Event* event) {
+        auto downloadPath = dirs::getTempDir() / (m_id + ".geode");
+
+        m_downloadListener.bind([this, hash = version.hash, version = version, downloadPath](web::WebTask::Event* event) {
             if (auto value = event->getValue()) {
                 if (value->ok()) {
-                    if (auto actualHash = ::calculateHash(value->data()); actualHash != hash) {
+                    if (auto actualHash = value->sha256().value_or(""); actualHash != hash) {
                         log::error("Failed to download {}, hash mismatch ({} != {})", m_id, actualHash, hash);
+                        std::error_code ec;
+                        std::filesystem::remove(downloadPath, ec);
                         m_status = DownloadStatusError {
                             .details = "Hash mismatch, downloaded file did not match what was expected",
                         };
@@ -138,11 +138,13 @@ public:
                     }
                     // If this was an update, delete the old file first
                     if (!removingInstalledWasError) {
-                        auto ok = file::writeBinary(dirs::getModsDir() / (m_id + ".geode"), value->data());
-                        if (!ok) {
+                        std::error_code ec;
+                        std::filesystem::rename(downloadPath, dirs::getModsDir() / (m_id + ".geode"), ec);
+                        if (ec) {
                             m_status = DownloadStatusError {
-                                .details = ok.unwrapErr(),
+                                .details = fmt::format("Unable to move downloaded .geode package: {}", ec.message()),
                             };
+                            std::filesystem::remove(downloadPath, ec);
                         }
                         else {
                             m_status = DownloadStatusDone {
@@ -165,18 +167,14 @@ public:
             else if (event->isCancelled()) {
                 m_status = DownloadStatusCancelled();
             }
-            // Throttle events to only once per frame to not cause a 
-            // billion UI updates at once 
-            if (m_scheduledEventForFrame != CCDirector::get()->getTotalFrames()) {
-                m_scheduledEventForFrame = CCDirector::get()->getTotalFrames();
-                Loader::get()->queueInMainThread([id = m_id]() {
-                    ModDownloadEvent(id).post();
-                });
-            }
+            Loader::get()->queueInMainThread([id = m_id]() {
+                ModDownloadEvent(id).post();
+            });
         });
 
         auto req = web::WebRequest();
         req.userAgent(getServerUserAgent());
+        req.downloadTo(downloadPath);
         m_downloadListener.setFilter(req.get(version.downloadURL));
         ModDownloadEvent(m_id).post();
     }
@@ -4,6 +4,7 @@
 #include <chrono>
 #include <date/date.h>
 #include <fmt/core.h>
+#include <list>
 #include <loader/ModMetadataImpl.hpp>
 #include <fmt/chrono.h>
 #include <loader/LoaderImpl.hpp>
@@ -14,67 +15,232 @@ using namespace server;
 
 #define GEODE_GD_VERSION_STR GEODE_STR(GEODE_GD_VERSION)
 
+// Hashes the argument tuples FunCache uses as keys. This is a struct so all
+// the overloads can see each other regardless of declaration order
+struct CacheKeyHash final {
+    static void combine(size_t& seed, size_t value) {
+        seed ^= value + 0x9e3779b9 + (seed << 6) + (seed >> 2);
+    }
+
+    template <class T>
+    static size_t hash(T const& value) {
+        return std::hash<T>()(value);
+    }
+    template <class T>
+    static size_t hash(std::optional<T> const& value) {
+        return value ? hash(*value) + 1 : 0;
+    }
+    template <class T>
+    static size_t hash(std::unordered_set<T> const& set) {
+        // Sets have no defined order, so their elements are combined in an
+        // order-independent way
+        size_t seed = set.size();
+        for (auto const& value : set) {
+            seed += hash(value);
+        }
+        return seed;
+    }
+    static size_t hash(ModsQuery const& query) {
+        size_t seed = 0;
+        combine(seed, hash(query.query));
+        combine(seed, hash(query.platforms));
+        combine(seed, hash(query.tags));
+        combine(seed, hash(query.featured));
+        combine(seed, static_cast<size_t>(query.sorting));
+        combine(seed, hash(query.developer));
+        combine(seed, query.page);
+        combine(seed, query.pageSize);
+        return seed;
+    }
+    static size_t hash(ModVersion const& version) {
+        size_t seed = version.index();
+        std::visit(makeVisitor {
+            [&](ModVersionLatest const&) {},
+            [&](ModVersionMajor const& ver) {
+                combine(seed, ver.major);
+            },
+            [&](ModVersionSpecific const& ver) {
+                combine(seed, hash(ver.toVString()));
+            },
+        }, version);
+        return seed;
+    }
+    template <class... Args>
+    static size_t hash(std::tuple<Args...> const& tuple) {
+        size_t seed = 0;
+        std::apply([&](auto const&... args) {
+            (combine(seed, hash(args)), ...);
+        }, tuple);
+        return seed;
+    }
+
+    template <class K>
+    size_t operator()(K const& key) const {
+        return hash(key);
+    }
+};
+
+// Rough estimates of how much memory cached values take up, used to keep the
+// caches within their budget
+struct CacheSize final {
+    // Parsed mod.json data kept around by ModMetadata
+    static constexpr size_t MOD_METADATA = 2048;
+
+    template <class T>
+    static size_t of(T const&) {
+        return sizeof(T);
+    }
+    static size_t of(std::string const& str) {
+        return sizeof(str) + str.size();
+    }
+    static size_t of(ByteVector const& data) {
+        return sizeof(data) + data.size();
+    }
+    static size_t of(ServerModVersion const& version) {
+        return sizeof(version) + MOD_METADATA + of(version.downloadURL) + of(version.hash);
+    }
+    static size_t of(ServerModMetadata const& mod) {
+        size_t size = sizeof(mod) + of(mod.id);
+        for (auto const& dev : mod.developers) {
+            size += sizeof(dev) + dev.username.size() + dev.displayName.size();
+        }
+        for (auto const& version : mod.versions) {
+            size += of(version);
+        }
+        for (auto const& tag : mod.tags) {
+            size += of(tag);
+        }
+        for (auto const& str : { &mod.about, &mod.changelog, &mod.repository }) {
+            size += str->has_value() ? str->value().size() : 0;
+        }
+        return size;
+    }
+    static size_t of(ServerModsList const& list) {
+        size_t size = sizeof(list);
+        for (auto const& mod : list.mods) {
+            size += of(mod);
+        }
+        return size;
+    }
+    static size_t of(std::vector<ServerTag> const& tags) {
+        size_t size = sizeof(tags);
+        for (auto const& tag : tags) {
+            size += sizeof(tag) + tag.name.size() + tag.displayName.size();
+        }
+        return size;
+    }
+    static size_t of(std::vector<ServerModUpdate> const& updates) {
+        return sizeof(updates) + updates.size() * sizeof(ServerModUpdate);
+    }
+
+    /**
+     * Size of a cached request, or nullopt if it's still pending and its
+     * size isn't known yet
+     */
+    template <class T>
+    static std::optional<size_t> of(ServerRequest<T>& request) {
+        if (request.isPending()) {
+            return std::nullopt;
+        }
+        auto result = request.getFinishedValue();
+        if (result && result->isOk()) {
+            auto const& value = result->unwrap();
+            return sizeof(request) + of(value);
+        }
+        return sizeof(request);
+    }
+};
+
+/**
+ * LRU cache bounded both by the estimated size of its values and by how many
+ * there are, since a page of mods and a logo differ in size by orders of
+ * magnitude. Not thread-safe by itself; FunCache guards it with a mutex
+ */
 template <class K, class V>
     requires std::equality_comparable<K> && std::copy_constructible<K>
 class CacheMap final {
 private:
-    // I know this looks like a goofy choice over just
-    // `std::unordered_map`, but hear me out:
-    //
-    // This needs preserved insertion order (so shrinking the cache
-    // to match size limits doesn't just have to erase random
-    // elements)
-    //
-    // If this used a map for values and another vector for storing
-    // insertion order, it would have a pretty big memory footprint
-    // (two copies of Query, one for order, one for map + two heap
-    // allocations on top of that)
-    //
-    // In addition, it would be a bad idea to have a cache of 1000s
-    // of items in any case (since that would likely take up a ton
-    // of memory, which we want to avoid since it's likely many
-    // crashes with the old index were due to too much memory
-    // usage)
-    //
-    // Linear searching a vector of at most a couple dozen items is
-    // lightning-fast (🚀), and besides the main performance benefit
-    // comes from the lack of a web request - not how many extra
-    // milliseconds we can squeeze out of a map access
-    std::vector<std::pair<K, V>> m_values;
-    size_t m_sizeLimit = 20;
+    struct Entry {
+        V value;
+        size_t size = 0;
+        bool sizeKnown = false;
+        typename std::list<K const*>::iterator lruPos;
+    };
+
+    std::unordered_map<K, Entry, CacheKeyHash> m_values;
+    // Most recently used first. Points into m_values, whose keys never move
+    std::list<K const*> m_lru;
+    size_t m_size = 0;
+    size_t m_sizeLimit = 20 * 1024 * 1024;
+    size_t m_entryLimit = 20;
+    size_t m_hits = 0;
+    size_t m_misses = 0;
+    size_t m_evictions = 0;
+
+    // Values are usually added while their request is still pending, so their
+    // size is only known once they finish
+    void updateSizes() {
+        for (auto& [_, entry] : m_values) {
+            if (entry.sizeKnown) continue;
+            if (auto size = CacheSize::of(entry.value)) {
+                m_size = m_size - entry.size + *size;
+                entry.size = *size;
+                entry.sizeKnown = true;
+            }
+        }
+    }
+    void erase(typename std::unordered_map<K, Entry, CacheKeyHash>::iterator it) {
+        m_size -= it->second.size;
+        m_lru.erase(it->second.lruPos);
+        m_values.erase(it);
+    }
+    void evict() {
+        this->updateSizes();
+        // The most recently used value is always kept, even if it's over the
+        // limit on its own
+        while ((m_size > m_sizeLimit || m_lru.size() > m_entryLimit) && m_lru.size() > 1) {
+            this->erase(m_values.find(*m_lru.back()));
+            m_evictions += 1;
+        }
+    }
 
 public:
     std::optional<V> get(K const& key) {
-        auto it = std::find_if(m_values.begin(), m_values.end(), [key](auto const& q) {
-            return q.first == key;
-        });
-        if (it != m_values.end()) {
-            return it->second;
+        auto it = m_values.find(key);
+        if (it == m_values.end()) {
+            m_misses += 1;
+            return std::nullopt;
         }
-        return std::nullopt;
+        m_hits += 1;
+        m_lru.splice(m_lru.begin(), m_lru, it->second.lruPos);
+        return it->second.value;
     }
     void add(K&& key, V&& value) {
-        auto pair = std::make_pair(std::move(key), std::move(value));
-
-        // Shift and replace last element if we're at cache size limit
-        if (m_values.size() >= m_sizeLimit) {
-            std::shift_left(m_values.begin(), m_values.end(), 1);
-            m_values.back() = std::move(pair);
-        }
-        // Otherwise append at end
-        else {
-            m_values.emplace_back(std::move(pair));
+        if (auto it = m_values.find(key); it != m_values.end()) {
+            this->erase(it);
         }
+        auto [it, _] = m_values.emplace(std::move(key), Entry { .value = std::move(value) });
+        m_lru.push_front(&it->first);
+        it->second.lruPos = m_lru.begin();
+        this->evict();
     }
     void remove(K const& key) {
-        ranges::remove(m_values, [&key](auto const& q) { return q.first == key; });
+        if (auto it = m_values.find(key); it != m_values.end()) {
+            this->erase(it);
+        }
     }
     void clear() {
         m_values.clear();
+        m_lru.clear();
+        m_size = 0;
     }
-    void limit(size_t size) {
-        m_sizeLimit = size;
-        m_values.clear();
+    void limit(size_t bytes) {
+        m_sizeLimit = bytes;
+        this->evict();
+    }
+    void limitEntries(size_t entries) {
+        m_entryLimit = entries;
+        this->evict();
     }
     size_t size() const {
         return m_values.size();
@@ -82,6 +248,19 @@ public:
     size_t limit() const {
         return m_sizeLimit;
     }
+    ServerCacheStats stats(std::string_view name) {
+        this->updateSizes();
+        return ServerCacheStats {
+            .name = std::string(name),
+            .entries = m_values.size(),
+            .size = m_size,
+            .sizeLimit = m_sizeLimit,
+            .entryLimit = m_entryLimit,
+            .hits = m_hits,
+            .misses = m_misses,
+            .evictions = m_evictions,
+        };
+    }
 };
 
 template <class F>
@@ -120,11 +299,17 @@ public:
 
     template <class... Args>
     ServerRequest<Value> get(Args const&... args) {
+        return this->getOr([&] { return Extract::invoke(F, args...); }, args...);
+    }
+
+    // Like get, but fills a miss by calling `fetch` instead of F
+    template <class Fetch, class... Args>
+    ServerRequest<Value> getOr(Fetch&& fetch, Args const&... args) {
         std::unique_lock lock(m_mutex);
         if (auto v = m_cache.get(Extract::key(args...))) {
             return *v;
         }
-        auto f = Extract::invoke(F, args...);
+        auto f = fetch();
         m_cache.add(Extract::key(args...), ServerRequest<Value>(f));
         return f;
     }
@@ -139,14 +324,22 @@ public:
         std::unique_lock lock(m_mutex);
         return m_cache.size();
     }
-    void limit(size_t size) {
+    void limit(size_t bytes) {
+        std::unique_lock lock(m_mutex);
+        m_cache.limit(bytes);
+    }
+    void limitEntries(size_t entries) {
         std::unique_lock lock(m_mutex);
-        m_cache.limit(size);
+        m_cache.limitEntries(entries);
     }
     void clear() {
         std::unique_lock lock(m_mutex);
         m_cache.clear();
     }
+    ServerCacheStats stats(std::string_view name) {
+        std::unique_lock lock(m_mutex);
+        return m_cache.stats(name);
+    }
 };
 
 template <auto F>
@@ -563,13 +756,12 @@ std::string server::getServerUserAgent() {
     return value;
 }
 
-ServerRequest<ServerModsList> server::getMods(ModsQuery const& query, bool useCache) {
-    if (useCache) {
-        return getCache<getMods>().get(query);
-    }
-
+// Requests made to fill the in-memory cache may also be answered from the
+// on-disk HTTP cache, but forced refreshes (useCache = false) must not be
+static ServerRequest<ServerModsList> fetchMods(ModsQuery const& query, bool useDiskCache) {
     auto req = web::WebRequest();
     req.userAgent(getServerUserAgent());
+    req.cache(useDiskCache);
 
     // Add search params
     if (query.query) {
@@ -631,12 +823,17 @@ ServerRequest<ServerModsList> server::getMods(ModsQuery const& query, bool useCa
     );
 }
 
-ServerRequest<ServerModMetadata> server::getMod(std::string const& id, bool useCache) {
+ServerRequest<ServerModsList> server::getMods(ModsQuery const& query, bool useCache) {
     if (useCache) {
-        return getCache<getMod>().get(id);
+        return getCache<getMods>().getOr([&] { return fetchMods(query, true); }, query);
     }
+    return fetchMods(query, false);
+}
+
+static ServerRequest<ServerModMetadata> fetchMod(std::string const& id, bool useDiskCache) {
     auto req = web::WebRequest();
     req.userAgent(getServerUserAgent());
+    req.cache(useDiskCache);
     return req.get(formatServerURL("/mods/{}", id)).map(
         [](web::WebResponse* response) -> Result<ServerModMetadata, ServerError> {
             if (response->ok()) {
@@ -660,6 +857,13 @@ ServerRequest<ServerModMetadata> server::getMod(std::string const& id, bool useC
     );
 }
 
+ServerRequest<ServerModMetadata> server::getMod(std::string const& id, bool useCache) {
+    if (useCache) {
+        return getCache<getMod>().getOr([&] { return fetchMod(id, true); }, id);
+    }
+    return fetchMod(id, false);
+}
+
 ServerRequest<ServerModVersion> server::getModVersion(std::string const& id, ModVersion const& version, bool useCache) {
     if (useCache) {
         auto& cache = getCache<getModVersion>();
@@ -721,6 +925,9 @@ ServerRequest<ByteVector> server::getModLogo(std::string const& id, bool useCach
     }
     auto req = web::WebRequest();
     req.userAgent(getServerUserAgent());
+    // Logos rarely change, so showing an outdated one until the next 
+    // time is fine
+    req.staleWhileRevalidate(std::chrono::days(7));
     return req.get(formatServerURL("/mods/{}/logo", id)).map(
         [](web::WebResponse* response) -> Result<ByteVector, ServerError> {
             if (response->ok()) {
@@ -902,12 +1109,33 @@ void server::clearServerCaches(bool clearGlobalCaches) {
     }
 }
 
+std::vector<ServerCacheStats> server::getServerCacheStats() {
+    return {
+        getCache<&getMods>().stats("getMods"),
+        getCache<&getMod>().stats("getMod"),
+        getCache<&getModVersion>().stats("getModVersion"),
+        getCache<&getModLogo>().stats("getModLogo"),
+        getCache<&getTags>().stats("getTags"),
+        getCache<&checkAllUpdates>().stats("checkAllUpdates"),
+    };
+}
+
 $on_mod(Loaded) {
     listenForSettingChanges<int64_t>("server-cache-size-limit", +[](int64_t size) {
-        getCache<&server::getMods>().limit(size);
-        getCache<&server::getMod>().limit(size);
-        getCache<&server::getModLogo>().limit(size);
-        getCache<&server::getTags>().limit(size);
-        getCache<&server::checkAllUpdates>().limit(size);
+        getCache<&server::getMods>().limitEntries(size);
+        getCache<&server::getMod>().limitEntries(size);
+        getCache<&server::getModVersion>().limitEntries(size);
+        getCache<&server::getModLogo>().limitEntries(size);
+        getCache<&server::getTags>().limitEntries(size);
+        getCache<&server::checkAllUpdates>().limitEntries(size);
+    });
+    listenForSettingChanges<int64_t>("server-cache-memory-limit", +[](int64_t megabytes) {
+        auto bytes = static_cast<size_t>(megabytes) * 1024 * 1024;
+        getCache<&server::getMods>().limit(bytes);
+        getCache<&server::getMod>().limit(bytes);
+        getCache<&server::getModVersion>().limit(bytes);
+        getCache<&server::getModLogo>().limit(bytes);
+        getCache<&server::getTags>().limit(bytes);
+        getCache<&server::checkAllUpdates>().limit(bytes);
     });
 }
@@ -180,4 +180,18 @@ namespace server {
     ServerRequest<std::vector<ServerModUpdate>> checkAllUpdates(bool useCache = true);
 
     void clearServerCaches(bool clearGlobalCaches = false);
+
+    struct ServerCacheStats final {
+        std::string name;
+        size_t entries;
+        // Estimated memory used by the cached values, in bytes
+        size_t size;
+        size_t sizeLimit;
+        size_t entryLimit;
+        size_t hits;
+        size_t misses;
+        size_t evictions;
+    };
+
+    std::vector<ServerCacheStats> getServerCacheStats();
 }
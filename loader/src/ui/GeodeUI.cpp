@@ -9,6 +9,7 @@
 #include "mods/settings/ModSettingsPopup.hpp"
 #include "mods/popups/ModPopup.hpp"
 #include "GeodeUIEvent.hpp"
+#include "ModLogoLoader.hpp"
 
 class LoadServerModLayer : public Popup<std::string const&> {
 protected:
@@ -170,9 +171,20 @@ using ModLogoSrc = std::variant<Mod*, std::string, std::filesystem::path>;
 
 class ModLogoSprite : public CCNode {
 protected:
+    // Logos may be shown at up to this many times their node size (like in
+    // the mod popup), so they're only downscaled that far
+    static constexpr float MAX_DISPLAY_SCALE = 2.f;
+
     std::string m_modID;
     CCNode* m_sprite = nullptr;
     EventListener<server::ServerRequest<ByteVector>> m_listener;
+    EventListener<ModLogoLoader::LoadTask> m_loadListener;
+    // Key of the logo in the texture cache
+    std::string m_textureKey;
+    // Kept so loading can be restarted if the node is removed from the scene
+    // and later added back before the logo has finished loading
+    ModLogoLoader::ReadFunc m_read;
+    bool m_loadCancelled = false;
 
     bool init(ModLogoSrc&& src) {
         if (!CCNode::init())
@@ -182,31 +194,44 @@ protected:
         this->setContentSize({ 50, 50 });
 
         m_listener.bind(this, &ModLogoSprite::onFetch);
+        m_loadListener.bind(this, &ModLogoSprite::onLoad);
     
         std::visit(makeVisitor {
             [this](Mod* mod) {
                 m_modID = mod->getID();
 
+                if (mod->isInternal()) {
+                    this->setSprite(CCSprite::createWithSpriteFrameName("geode-logo.png"_spr), false);
+                    return;
+                }
                 // Load from Resources
-                this->setSprite(mod->isInternal() ? 
-                    CCSprite::createWithSpriteFrameName("geode-logo.png"_spr) : 
-                    CCSprite::create(fmt::format("{}/logo.png", mod->getID()).c_str()),
-                    false
-                );
+                auto path = std::string(CCFileUtils::get()->fullPathForFilename(
+                    fmt::format("{}/logo.png", mod->getID()).c_str(), false
+                ));
+                m_textureKey = fmt::format("geode-logo:{}", path);
+                if (!this->setCachedSprite()) {
+                    this->load([path = std::move(path)] {
+                        return file::readBinary(path);
+                    });
+                }
             },
             [this](std::string const& id) {
                 m_modID = id;
-                
+                m_textureKey = fmt::format("geode-logo:server:{}", id);
+                if (this->setCachedSprite()) {
+                    return;
+                }
                 // Asynchronously fetch from server
                 this->setSprite(createLoadingCircle(25), false);
                 m_listener.setFilter(server::getModLogo(id));
             },
             [this](std::filesystem::path const& path) {
-                this->setSprite(nullptr, false);
-                if (auto unzip = file::Unzip::create(path)) {
-                    if (auto logo = unzip.unwrap().extract("logo.png")) {
-                        this->setSprite(std::move(logo.unwrap()), false);
-                    }
+                m_textureKey = fmt::format("geode-logo:{}", path);
+                if (!this->setCachedSprite()) {
+                    this->load([path] () -> Result<ByteVector> {
+                        GEODE_UNWRAP_INTO(auto unzip, file::Unzip::create(path));
+                        return unzip.extract("logo.png");
+                    });
                 }
             },
         }, src);
@@ -239,12 +264,39 @@ protected:
             ModLogoUIEvent(std::make_unique<ModLogoUIEvent::Impl>(this, m_modID)).post();
         }
     }
-    void setSprite(ByteVector&& data, bool postEvent) {
-        auto image = Ref(new CCImage());
-        image->initWithImageData(data.data(), data.size());
+    bool setCachedSprite() {
+        if (auto texture = CCTextureCache::get()->textureForKey(m_textureKey.c_str())) {
+            this->setSprite(CCSprite::createWithTexture(texture), false);
+            return true;
+        }
+        return false;
+    }
+
+    void load(ModLogoLoader::ReadFunc read) {
+        m_read = std::move(read);
+        m_loadCancelled = false;
+        if (!m_sprite) {
+            this->setSprite(createLoadingCircle(25), false);
+        }
+        auto maxSize = static_cast<unsigned int>(std::ceil(
+            std::max(m_obContentSize.width, m_obContentSize.height) * 
+            CCDirector::get()->getContentScaleFactor() * MAX_DISPLAY_SCALE
+        ));
+        m_loadListener.setFilter(ModLogoLoader::get().load(m_read, maxSize));
+    }
 
-        auto texture = CCTextureCache::get()->addUIImage(image, m_modID.c_str());
-        this->setSprite(CCSprite::createWithTexture(texture), postEvent);
+    void onLoad(ModLogoLoader::LoadTask::Event* event) {
+        if (auto result = event->getValue()) {
+            if (result->isErr()) {
+                log::debug("Unable to load logo for {}: {}", m_modID, result->unwrapErr());
+                this->setSprite(nullptr, true);
+            }
+            else {
+                auto texture = ModLogoLoader::upload(result->unwrap(), m_textureKey);
+                this->setSprite(CCSprite::createWithTexture(texture), true);
+            }
+            m_read = nullptr;
+        }
     }
 
     void onFetch(server::ServerRequest<ByteVector>::Event* event) {
@@ -253,9 +305,12 @@ protected:
             if (result->isErr()) {
                 this->setSprite(nullptr, true);
             }
-            // Otherwise load downloaded sprite to memory
+            // Otherwise decode the downloaded sprite
             else {
-                this->setSprite(std::move(result->unwrap()), true);
+                auto data = std::make_shared<ByteVector>(std::move(result->unwrap()));
+                this->load([data]() -> Result<ByteVector> {
+                    return Ok(*data);
+                });
             }
         }
         else if (event->isCancelled()) {
@@ -263,6 +318,21 @@ protected:
         }
     }
 
+    void onEnter() override {
+        CCNode::onEnter();
+        if (m_loadCancelled && m_read) {
+            this->load(m_read);
+        }
+    }
+    void onExit() override {
+        CCNode::onExit();
+        // Don't keep decoding logos that have been scrolled out of view
+        if (m_read && m_loadListener.getFilter().isPending()) {
+            m_loadListener.getFilter().cancel();
+            m_loadCancelled = true;
+        }
+    }
+
 public:
     static ModLogoSprite* create(ModLogoSrc&& src) {
         auto ret = new ModLogoSprite();
@@ -0,0 +1,290 @@
+#include "ModLogoLoader.hpp"
+#include <Geode/cocos/platform/IncludeZlib.h>
+#include <Geode/loader/Dirs.hpp>
+#include <Geode/loader/Log.hpp>
+#include <Geode/utils/file.hpp>
+#include <hash/hash.hpp>
+#include <cmath>
+#include <cstring>
+
+namespace {
+    // Logo downscaled to its display size, as straight (not premultiplied)
+    // RGBA8888
+    struct Thumbnail {
+        ByteVector pixels;
+        uint32_t width;
+        uint32_t height;
+    };
+
+    // Cache files are this header followed by the zlib-compressed pixels
+    struct ThumbnailHeader {
+        uint32_t magic;
+        uint32_t width;
+        uint32_t height;
+    };
+    constexpr uint32_t THUMBNAIL_MAGIC = 0x314f4c47; // "GLO1"
+}
+
+// CCObjects start out with a reference meant for the autorelease pool, which
+// must not be touched outside the main thread
+static Ref<CCImage> adopt(CCImage* image) {
+    Ref<CCImage> ref(image);
+    image->release();
+    return ref;
+}
+
+static Result<Ref<CCImage>> imageFromThumbnail(Thumbnail& thumb) {
+    auto image = adopt(new CCImage());
+    if (!image->initWithImageData(
+        thumb.pixels.data(), thumb.pixels.size(), CCImage::kFmtRawData, thumb.width, thumb.height, 8
+    )) {
+        return Err("Unable to create image from thumbnail");
+    }
+    return Ok(image);
+}
+
+static std::optional<Thumbnail> readThumbnail(std::filesystem::path const& path) {
+    auto res = file::readBinary(path);
+    if (!res) {
+        return std::nullopt;
+    }
+    auto data = std::move(res).unwrap();
+    ThumbnailHeader header;
+    if (data.size() < sizeof(header)) {
+        return std::nullopt;
+    }
+    std::memcpy(&header, data.data(), sizeof(header));
+    if (header.magic != THUMBNAIL_MAGIC || header.width == 0 || header.height == 0) {
+        return std::nullopt;
+    }
+    Thumbnail thumb {
+        .pixels = ByteVector(header.width * header.height * 4),
+        .width = header.width,
+        .height = header.height,
+    };
+    uLongf size = thumb.pixels.size();
+    if (
+        uncompress(thumb.pixels.data(), &size, data.data() + sizeof(header), data.size() - sizeof(header)) != Z_OK ||
+        size != thumb.pixels.size()
+    ) {
+        return std::nullopt;
+    }
+    // Touch the file so pruning evicts the least recently used thumbnails
+    std::error_code ec;
+    std::filesystem::last_write_time(path, std::filesystem::file_time_type::clock::now(), ec);
+    return thumb;
+}
+
+static void writeThumbnail(std::filesystem::path const& path, Thumbnail const& thumb) {
+    ThumbnailHeader header {
+        .magic = THUMBNAIL_MAGIC,
+        .width = thumb.width,
+        .height = thumb.height,
+    };
+    uLongf size = compressBound(thumb.pixels.size());
+    ByteVector data(sizeof(header) + size);
+    std::memcpy(data.data(), &header, sizeof(header));
+    if (compress2(data.data() + sizeof(header), &size, thumb.pixels.data(), thumb.pixels.size(), Z_BEST_SPEED) != Z_OK) {
+        return;
+    }
+    data.resize(sizeof(header) + size);
+
+    // Written to a temporary file first so a crash can't leave a half-written
+    // thumbnail behind
+    auto tmp = path;
+    tmp += ".tmp";
+    if (auto res = file::writeBinary(tmp, data); !res) {
+        log::warn("Unable to cache logo thumbnail: {}", res.unwrapErr());
+        return;
+    }
+    std::error_code ec;
+    std::filesystem::rename(tmp, path, ec);
+}
+
+static Thumbnail downscale(CCImage* image, uint32_t width, uint32_t height) {
+    uint32_t const srcWidth = image->getWidth();
+    uint32_t const srcHeight = image->getHeight();
+    size_t const channels = image->hasAlpha() ? 4 : 3;
+    bool const premultiplied = image->hasAlpha() && image->isPremultipliedAlpha();
+    auto const src = image->getData();
+
+    Thumbnail thumb {
+        .pixels = ByteVector(width * height * 4),
+        .width = width,
+        .height = height,
+    };
+    auto out = thumb.pixels.data();
+
+    // Box filter; colors are weighted by alpha so fully transparent pixels
+    // don't bleed their (meaningless) color into the edges
+    for (uint32_t y = 0; y < height; y++) {
+        uint32_t const y0 = y * srcHeight / height;
+        uint32_t const y1 = std::max(y0 + 1, (y + 1) * srcHeight / height);
+        for (uint32_t x = 0; x < width; x++) {
+            uint32_t const x0 = x * srcWidth / width;
+            uint32_t const x1 = std::max(x0 + 1, (x + 1) * srcWidth / width);
+
+            uint64_t r = 0, g = 0, b = 0, a = 0;
+            for (uint32_t sy = y0; sy < y1; sy++) {
+                auto p = src + (static_cast<size_t>(sy) * srcWidth + x0) * channels;
+                for (uint32_t sx = x0; sx < x1; sx++, p += channels) {
+                    uint32_t const alpha = channels == 4 ? p[3] : 255;
+                    uint32_t const weight = premultiplied ? 255 : alpha;
+                    r += p[0] * weight;
+                    g += p[1] * weight;
+                    b += p[2] * weight;
+                    a += alpha;
+                }
+            }
+            auto const count = static_cast<uint64_t>(x1 - x0) * (y1 - y0);
+            if (a > 0) {
+                out[0] = static_cast<uint8_t>(std::min<uint64_t>(255, r / a));
+                out[1] = static_cast<uint8_t>(std::min<uint64_t>(255, g / a));
+                out[2] = static_cast<uint8_t>(std::min<uint64_t>(255, b / a));
+            }
+            else {
+                out[0] = out[1] = out[2] = 0;
+            }
+            out[3] = static_cast<uint8_t>((a + count / 2) / count);
+            out += 4;
+        }
+    }
+    return thumb;
+}
+
+static Result<Ref<CCImage>> decodeLogo(ByteVector const& data, unsigned int maxSize) {
+    auto const cachePath = ModLogoLoader::getCacheDir() / fmt::format("{}-{}.bin", calculateHash(data), maxSize);
+    if (auto thumb = readThumbnail(cachePath)) {
+        return imageFromThumbnail(*thumb);
+    }
+
+    auto image = adopt(new CCImage());
+    // initWithImageData takes a non-const pointer but doesn't modify the data
+    if (!image->initWithImageData(const_cast<uint8_t*>(data.data()), data.size())) {
+        return Err("Unable to decode image");
+    }
+    if (image->getBitsPerComponent() != 8) {
+        return Err("Unsupported image format");
+    }
+
+    uint32_t const width = image->getWidth();
+    uint32_t const height = image->getHeight();
+    auto const scale = static_cast<float>(maxSize) / std::max(width, height);
+    // Small logos are cheap to decode, so there's no point caching them
+    if (scale >= 1.f) {
+        return Ok(image);
+    }
+    auto thumb = downscale(
+        image,
+        std::max<uint32_t>(1, std::lround(width * scale)),
+        std::max<uint32_t>(1, std::lround(height * scale))
+    );
+    writeThumbnail(cachePath, thumb);
+    return imageFromThumbnail(thumb);
+}
+
+ModLogoLoader::ModLogoLoader() {
+    (void)file::createDirectoryAll(getCacheDir());
+
+    // Prune the disk cache down to its size limit, oldest thumbnails first
+    geode_internal::enqueueTask([] {
+        std::error_code ec;
+
+        struct Entry {
+            std::filesystem::path path;
+            std::filesystem::file_time_type time;
+            size_t size;
+        };
+        std::vector<Entry> entries;
+        size_t total = 0;
+        for (auto const& item : std::filesystem::directory_iterator(getCacheDir(), ec)) {
+            if (!item.is_regular_file(ec)) continue;
+            entries.push_back(Entry {
+                .path = item.path(),
+                .time = item.last_write_time(ec),
+                .size = item.file_size(ec),
+            });
+            total += entries.back().size;
+        }
+        if (total <= CACHE_SIZE_LIMIT) {
+            return;
+        }
+        std::sort(entries.begin(), entries.end(), [](auto const& a, auto const& b) {
+            return a.time < b.time;
+        });
+        for (auto const& entry : entries) {
+            if (total <= CACHE_SIZE_LIMIT) break;
+            if (std::filesystem::remove(entry.path, ec)) {
+                total -= entry.size;
+            }
+        }
+    }, TaskPriority::Background);
+}
+
+ModLogoLoader& ModLogoLoader::get() {
+    // Intentionally leaked, since queued jobs may still refer to it on exit
+    static auto inst = new ModLogoLoader();
+    return *inst;
+}
+
+std::filesystem::path ModLogoLoader::getCacheDir() {
+    return dirs::getGeodeDir() / "logo-cache";
+}
+
+void ModLogoLoader::pump() {
+    std::unique_lock lock(m_mutex);
+    while (m_running < MAX_CONCURRENT && !m_pending.empty()) {
+        // Newest first, since those are the logos that were scrolled to last
+        auto job = std::move(m_pending.back());
+        m_pending.pop_back();
+        if (job.hasBeenCancelled()) {
+            job.finish(LoadTask::Cancel());
+            continue;
+        }
+        m_running += 1;
+        geode_internal::enqueueTask([this, job = std::move(job)]() mutable {
+            this->run(job);
+            {
+                std::unique_lock lock(m_mutex);
+                m_running -= 1;
+            }
+            this->pump();
+        }, TaskPriority::Normal);
+    }
+}
+
+void ModLogoLoader::run(Job& job) {
+    auto data = job.read();
+    if (!data) {
+        job.finish(Err(data.unwrapErr()));
+        return;
+    }
+    // Reading may have taken a while
+    if (job.hasBeenCancelled()) {
+        job.finish(LoadTask::Cancel());
+        return;
+    }
+    job.finish(decodeLogo(data.unwrap(), job.maxSize));
+}
+
+ModLogoLoader::LoadTask ModLogoLoader::load(ReadFunc read, unsigned int maxSize) {
+    return LoadTask::runWithCallback(
+        [this, read = std::move(read), maxSize](auto finish, auto, auto hasBeenCancelled) mutable {
+            {
+                std::unique_lock lock(m_mutex);
+                m_pending.push_back(Job {
+                    .read = std::move(read),
+                    .maxSize = maxSize,
+                    .finish = std::move(finish),
+                    .hasBeenCancelled = std::move(hasBeenCancelled),
+                });
+            }
+            this->pump();
+        },
+        "Mod logo"
+    );
+}
+
+CCTexture2D* ModLogoLoader::upload(CCImage* image, std::string const& key) {
+    return CCTextureCache::get()->addUIImage(image, key.c_str());
+}
@@ -0,0 +1,62 @@
+#pragma once
+
+#include <Geode/utils/cocos.hpp>
+#include <Geode/utils/general.hpp>
+#include <Geode/utils/Task.hpp>
+#include <deque>
+#include <filesystem>
+#include <mutex>
+
+using namespace geode::prelude;
+
+/**
+ * Decodes mod logos on the Task thread pool and downscales them to the size
+ * they're shown at, so the main thread only has to upload the texture.
+ * Downscaled logos are kept in a disk cache keyed by the hash of the original
+ * image, which persists across sessions. Only a few logos are decoded at a
+ * time, newest request first, and requests whose Task has been cancelled
+ * (for example because the logo was removed from the screen) are skipped
+ */
+class ModLogoLoader final {
+public:
+    using LoadTask = Task<Result<Ref<CCImage>>>;
+    // Reads the original image file; runs on a worker thread
+    using ReadFunc = std::function<Result<ByteVector>()>;
+
+    static constexpr size_t MAX_CONCURRENT = 4;
+    static constexpr size_t CACHE_SIZE_LIMIT = 32 * 1024 * 1024;
+
+private:
+    struct Job {
+        ReadFunc read;
+        unsigned int maxSize;
+        LoadTask::PostResult finish;
+        LoadTask::HasBeenCancelled hasBeenCancelled;
+    };
+
+    std::mutex m_mutex;
+    std::deque<Job> m_pending;
+    size_t m_running = 0;
+
+    ModLogoLoader();
+
+    void pump();
+    void run(Job& job);
+
+public:
+    static ModLogoLoader& get();
+    static std::filesystem::path getCacheDir();
+
+    /**
+     * Load a logo
+     * @param read Function for reading the original image file
+     * @param maxSize The largest width or height in pixels the logo will be
+     * shown at; larger images are downscaled to fit
+     */
+    LoadTask load(ReadFunc read, unsigned int maxSize);
+
+    /**
+     * Upload a loaded logo into the texture cache. Main thread only
+     */
+    static CCTexture2D* upload(CCImage* image, std::string const& key);
+};
@@ -213,7 +213,6 @@ bool ModItem::init(ModSource&& source) {
                 // Manually handle toggle state
                 m_enableToggle->m_notClickable = true;
                 m_viewMenu->addChild(m_enableToggle);
-                m_viewMenu->updateLayout();
             }
             if (mod->hasLoadProblems() || mod->targetsOutdatedVersion()) {
                 auto viewErrorSpr = createGeodeCircleButton(
@@ -365,13 +364,11 @@ void ModItem::updateState() {
     bool isDownloading = download && download->isActive();
 
     // Update the size of the mod cell itself
+    this->setContentSize(getItemSize(m_targetWidth, m_display));
     if (m_display == ModListDisplay::Grid) {
-        auto widthWithoutGaps = m_targetWidth - 7.5f;
-        this->setContentSize(ccp(widthWithoutGaps / roundf(widthWithoutGaps / 80), 100));
         m_bg->setContentSize(m_obContentSize / m_bg->getScale());
     }
     else {
-        this->setContentSize(ccp(m_targetWidth, m_display == ModListDisplay::BigList ? 40 : 30));
         m_bg->setContentSize((m_obContentSize - ccp(6, 0)) / m_bg->getScale());
     }
 
@@ -719,6 +716,14 @@ void ModItem::updateState() {
     ModItemUIEvent(std::make_unique<ModItemUIEvent::Impl>(this)).post();
 }
 
+CCSize ModItem::getItemSize(float width, ModListDisplay display) {
+    if (display == ModListDisplay::Grid) {
+        auto widthWithoutGaps = width - 7.5f;
+        return CCSize(widthWithoutGaps / roundf(widthWithoutGaps / 80), 100);
+    }
+    return CCSize(width, display == ModListDisplay::BigList ? 40 : 30);
+}
+
 void ModItem::updateDisplay(float width, ModListDisplay display) {
     m_display = display;
     m_targetWidth = width;
@@ -55,13 +55,13 @@ class ModItem : public CCNode {
 protected:
     ModSource m_source;
     CCScale9Sprite* m_bg;
-    CCNode* m_logo;
+    CCNode* m_logo = nullptr;
     CCNode* m_infoContainer;
     CCNode* m_titleContainer;
     Ref<CCLabelBMFont> m_titleLabel;
     CCLabelBMFont* m_versionLabel;
     CCNode* m_developers;
-    CCNode* m_recommendedBy;
+    CCNode* m_recommendedBy = nullptr;
     CCScale9Sprite* m_description;
     CCLabelBMFont* m_developerLabel;
     ButtonSprite* m_restartRequiredLabel;
@@ -102,6 +102,11 @@ protected:
 public:
     static ModItem* create(ModSource&& source);
 
+    /**
+     * Get the size of an item for the given list width and display mode
+     */
+    static CCSize getItemSize(float width, ModListDisplay display);
+
     void updateDisplay(float width, ModListDisplay display);
 
     ModSource& getSource() &;
@@ -393,6 +393,9 @@ bool ModList::init(ModListSource* src, CCSize const& size) {
     this->gotoPage(0);
     this->updateTopContainer();
 
+    // ScrollLayer has no callback for scrolling, so the position is polled
+    this->scheduleUpdate();
+
     return true;
 }
 
@@ -403,27 +406,14 @@ void ModList::onPromise(ModListSource::PageLoadTask::Event* event) {
             // Hide status
             m_statusContainer->setVisible(false);
 
-            auto list = result->unwrap();
-
-            // Create items
-            bool first = true;
-            for (auto item : list) {
-                // Add separators between items after the first one
-                if (!first) {
-                    // auto separator = CCLayerColor::create(
-                    //     ColorProvider::get()->define("mod-list-separator"_spr, { 255, 255, 255, 45 })
-                    // );
-                    // separator->setContentSize({ m_obContentSize.width - 10, .5f });
-                    // m_list->m_contentLayer->addChild(separator);
-                }
-                first = false;
-                m_list->m_contentLayer->addChild(item);
-            }
+            // Items are created as they come into view
+            m_items = result->unwrap();
             this->updateDisplay(m_display);
 
             // Scroll list to top
             auto listTopScrollPos = -m_list->m_contentLayer->getContentHeight() + m_list->getContentHeight();
             m_list->m_contentLayer->setPositionY(listTopScrollPos);
+            this->updateVisibleRows();
 
             // Update page UI
             this->updateState();
@@ -568,53 +558,108 @@ void ModList::updateDisplay(ModListDisplay display) {
     m_display = display;
     m_source->setPageSize(getDisplayPageSize(m_source, m_display));
 
-    // Update all BaseModItems that are children of the list
-    // There may be non-BaseModItems there (like separators) so gotta be type-safe
-    for (auto& node : CCArrayExt<CCNode*>(m_list->m_contentLayer->getChildren())) {
-        if (auto item = typeinfo_cast<ModItem*>(node)) {
-            item->updateDisplay(m_list->getContentWidth(), display);
-        }
-    }
-
     // Store old relative scroll position (ensuring no divide by zero happens)
     auto oldPositionArea = m_list->m_contentLayer->getContentHeight() - m_list->getContentHeight();
     auto oldPosition = oldPositionArea > 0.f ?
         m_list->m_contentLayer->getPositionY() / oldPositionArea : 
         -1.f;
 
-    // Update the list layout based on the display model
-    if (display == ModListDisplay::Grid) {
-        m_list->m_contentLayer->setLayout(
-            RowLayout::create()
-                ->setGrowCrossAxis(true)
-                ->setAxisAlignment(AxisAlignment::Start)
-                ->setGap(2.5f)
-        );
-    }
-    else {
-        m_list->m_contentLayer->setLayout(
-            ColumnLayout::create()
-                ->setAxisReverse(true)
-                ->setAxisAlignment(AxisAlignment::End)
-                ->setAutoGrowAxis(m_obContentSize.height)
-                ->setGap(2.5f)
-        );
-    }
+    // All items are the same size, so the list can be laid out without 
+    // creating them
+    auto width = m_list->getContentWidth();
+    m_itemSize = ModItem::getItemSize(width, display);
+    m_columns = display == ModListDisplay::Grid ?
+        std::max<size_t>(1, static_cast<size_t>((width + ITEM_GAP) / (m_itemSize.width + ITEM_GAP))) : 
+        1;
+    auto rows = (m_items.size() + m_columns - 1) / m_columns;
+    auto height = rows > 0 ? rows * m_itemSize.height + (rows - 1) * ITEM_GAP : 0.f;
 
     // Make sure list isn't too small
-    // NOTE: Do NOT call `updateLayout` on m_list, it'll undo this!
-    if (m_list->m_contentLayer->getContentHeight() < m_list->getContentHeight()) {
-        auto diff = m_list->getContentHeight() - m_list->m_contentLayer->getContentHeight();
-        m_list->m_contentLayer->setContentHeight(m_list->getContentHeight());
-        for (auto child : CCArrayExt<CCNode*>(m_list->m_contentLayer->getChildren())) {
-            child->setPositionY(child->getPositionY() + diff);
-        }
+    m_list->m_contentLayer->setContentSize({ width, std::max(height, m_list->getContentHeight()) });
+
+    for (auto& [index, item] : m_rows) {
+        item->updateDisplay(width, display);
+        item->setPosition(this->getItemPosition(index));
     }
 
     // Preserve relative scroll position
     m_list->m_contentLayer->setPositionY((
         m_list->m_contentLayer->getContentHeight() - m_list->getContentHeight()
     ) * oldPosition);
+
+    this->updateVisibleRows();
+}
+
+CCPoint ModList::getItemPosition(size_t index) const {
+    auto row = index / m_columns;
+    auto column = index % m_columns;
+    // Grid rows start from the left, list items are centered
+    auto x = m_display == ModListDisplay::Grid ?
+        column * (m_itemSize.width + ITEM_GAP) : 
+        (m_list->getContentWidth() - m_itemSize.width) / 2;
+    auto y = m_list->m_contentLayer->getContentHeight() - (row + 1) * m_itemSize.height - row * ITEM_GAP;
+    return ccp(x, y);
+}
+
+void ModList::update(float) {
+    if (m_list->m_contentLayer->getPositionY() != m_lastScrollPos) {
+        this->updateVisibleRows();
+    }
+}
+
+void ModList::updateVisibleRows() {
+    m_lastScrollPos = m_list->m_contentLayer->getPositionY();
+    if (m_items.empty()) {
+        return this->clearRows();
+    }
+
+    // The part of the content layer in view, measured from its top
+    auto contentHeight = m_list->m_contentLayer->getContentHeight();
+    auto viewTop = std::max(0.f, contentHeight + m_lastScrollPos - m_list->getContentHeight());
+    auto viewBottom = std::max(0.f, contentHeight + m_lastScrollPos);
+    auto rowHeight = m_itemSize.height + ITEM_GAP;
+    auto rowCount = (m_items.size() + m_columns - 1) / m_columns;
+
+    auto firstRow = static_cast<size_t>(viewTop / rowHeight);
+    firstRow = firstRow > OVERSCAN_ROWS ? firstRow - OVERSCAN_ROWS : 0;
+    auto lastRow = std::min(rowCount, static_cast<size_t>(viewBottom / rowHeight) + 1 + OVERSCAN_ROWS);
+    auto first = firstRow * m_columns;
+    auto last = std::min(m_items.size(), lastRow * m_columns);
+
+    for (auto it = m_rows.begin(); it != m_rows.end();) {
+        if (it->first < first || it->first >= last) {
+            this->removeItem(it->second);
+            it = m_rows.erase(it);
+        }
+        else {
+            ++it;
+        }
+    }
+
+    for (size_t i = first; i < last; i += 1) {
+        if (m_rows.contains(i)) {
+            continue;
+        }
+        // Items are created fresh rather than reused for another mod, since 
+        // mods decorating them through ModItemUIEvent expect each item to 
+        // only ever show one mod
+        auto item = ModItem::create(ModSource(m_items[i]));
+        item->updateDisplay(m_list->getContentWidth(), m_display);
+        item->setPosition(this->getItemPosition(i));
+        m_list->m_contentLayer->addChild(item);
+        m_rows.insert({ i, item });
+    }
+}
+
+void ModList::removeItem(ModItem* item) {
+    item->removeFromParent();
+}
+
+void ModList::clearRows() {
+    for (auto& [index, item] : m_rows) {
+        this->removeItem(item);
+    }
+    m_rows.clear();
 }
 
 void ModList::updateState() {
@@ -659,7 +704,8 @@ void ModList::reloadPage() {
 
 void ModList::gotoPage(size_t page, bool update) {
     // Clear list contents
-    m_list->m_contentLayer->removeAllChildren();
+    this->clearRows();
+    m_items.clear();
     m_page = page;
 
     // Update page size (if needed)
@@ -676,7 +722,8 @@ void ModList::gotoPage(size_t page, bool update) {
 
 void ModList::showStatus(ModListStatus status, std::string const& message, std::optional<std::string> const& details) {
     // Clear list contents
-    m_list->m_contentLayer->removeAllChildren();
+    this->clearRows();
+    m_items.clear();
 
     // Update status
     m_statusTitle->setString(message.c_str());
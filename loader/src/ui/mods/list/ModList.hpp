@@ -21,9 +21,20 @@ using ModListStatus = std::variant<ModListErrorStatus, ModListUnkProgressStatus,
 
 class ModList : public CCNode {
 protected:
+    static constexpr float ITEM_GAP = 2.5f;
+    // How many rows of items to keep around above and below the visible ones
+    static constexpr size_t OVERSCAN_ROWS = 2;
+
     ModListSource* m_source;
     size_t m_page = 0;
     ScrollLayer* m_list;
+    // Mods on the current page
+    ModListSource::Page m_items;
+    // Items only exist for the mods in view, keyed by index in m_items
+    std::unordered_map<size_t, Ref<ModItem>> m_rows;
+    CCSize m_itemSize;
+    size_t m_columns = 1;
+    float m_lastScrollPos = 0.f;
     CCMenu* m_statusContainer;
     CCLabelBMFont* m_statusTitle;
     SimpleTextArea* m_statusDetails;
@@ -59,6 +70,11 @@ protected:
     bool init(ModListSource* src, CCSize const& size);
 
     void updateTopContainer();
+    void update(float dt) override;
+    void updateVisibleRows();
+    void removeItem(ModItem* item);
+    void clearRows();
+    CCPoint getItemPosition(size_t index) const;
     void onCheckUpdates(typename server::ServerRequest<std::vector<std::string>>::Event* event);
     void onInvalidateCache(InvalidateCacheEvent* event);
 
@@ -26,7 +26,9 @@ bool InstalledModsQuery::queryCheck(ModSource const& src, double& weighted) cons
         addToList = src.asMod()->isEnabled() == *enabledOnly;
     }
     if (query) {
-        addToList = modFuzzyMatch(src.asMod()->getMetadata(), *query, weighted);
+        auto score = ModSearchIndex::get().match(src.asMod(), *query);
+        addToList = score.has_value();
+        weighted = score.value_or(weighted);
     }
     // Loader gets boost to ensure it's normally always top of the list
     if (addToList && src.asMod()->isInternal()) {
@@ -86,6 +88,10 @@ InstalledModListSource::ProviderTask InstalledModListSource::fetchPage(size_t pa
         m_query.pageSize = Loader::get()->getAllMods().size();
     }
 
+    if (m_query.query) {
+        ModSearchIndex::get().refresh();
+    }
+
     auto content = ModListSource::ProvidedMods();
     for (auto& mod : Loader::get()->getAllMods()) {
         content.mods.push_back(ModSource(mod));
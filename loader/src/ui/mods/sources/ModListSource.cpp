@@ -40,10 +40,7 @@ typename ModListSource::PageLoadTask ModListSource::loadPage(size_t page, bool f
                 if (data.totalModCount == 0 || data.mods.empty()) {
                     return Err(LoadPageError("No mods found :("));
                 }
-                auto pageData = Page();
-                for (auto mod : std::move(data.mods)) {
-                    pageData.push_back(ModItem::create(std::move(mod)));
-                }
+                auto pageData = Page(std::move(data.mods));
                 m_cachedItemCount = data.totalModCount;
                 m_cachedPages.insert({ page, pageData });
                 return Ok(pageData);
@@ -100,21 +97,132 @@ bool weightedFuzzyMatch(std::string const& str, std::string const& kw, double we
     }
     return false;
 }
-bool modFuzzyMatch(ModMetadata const& metadata, std::string const& kw, double& weighted) {
-    bool addToList = false;
-    addToList |= weightedFuzzyMatch(metadata.getName(), kw, 1, weighted);
-    addToList |= weightedFuzzyMatch(metadata.getID(), kw, 0.5, weighted);
-    for (auto& dev : metadata.getDevelopers()) {
-        addToList |= weightedFuzzyMatch(dev, kw, 0.25, weighted);
+
+ModSearchIndex::CharSet::CharSet(std::string const& str) {
+    for (auto c : str) {
+        auto ch = static_cast<unsigned char>(c);
+        // Non-ASCII characters are left out, which only makes the set less 
+        // strict
+        if (ch < 128) {
+            ch = static_cast<unsigned char>(std::tolower(ch));
+            m_bits[ch / 64] |= uint64_t(1) << (ch % 64);
+        }
+    }
+}
+ModSearchIndex::CharSet& ModSearchIndex::CharSet::operator|=(CharSet const& other) {
+    m_bits[0] |= other.m_bits[0];
+    m_bits[1] |= other.m_bits[1];
+    return *this;
+}
+bool ModSearchIndex::CharSet::contains(CharSet const& other) const {
+    return (m_bits[0] & other.m_bits[0]) == other.m_bits[0] && 
+        (m_bits[1] & other.m_bits[1]) == other.m_bits[1];
+}
+
+ModSearchIndex& ModSearchIndex::get() {
+    static auto inst = new ModSearchIndex();
+    return *inst;
+}
+
+void ModSearchIndex::refresh() {
+    auto mods = Loader::get()->getAllMods();
+    std::unique_lock lock(m_mutex);
+
+    bool stale = mods.size() != m_entries.size();
+    for (size_t i = 0; !stale && i < mods.size(); i += 1) {
+        stale = mods[i] != m_entries[i].mod || mods[i]->getVersion() != m_entries[i].version;
+    }
+    if (!stale) {
+        return;
+    }
+
+    m_entries.clear();
+    m_indices.clear();
+    for (auto mod : mods) {
+        // Weights match the importance of each field in the results
+        auto metadata = mod->getMetadata();
+        auto entry = Entry {
+            .mod = mod,
+            .version = metadata.getVersion(),
+        };
+        auto addField = [&](std::string const& text, double weight) {
+            auto field = Field {
+                .text = text,
+                .weight = weight,
+                .chars = CharSet(text),
+            };
+            entry.chars |= field.chars;
+            entry.fields.push_back(std::move(field));
+        };
+        addField(metadata.getName(), 1);
+        addField(metadata.getID(), 0.5);
+        for (auto& dev : metadata.getDevelopers()) {
+            addField(dev, 0.25);
+        }
+        if (auto details = metadata.getDetails()) {
+            addField(*details, 0.005);
+        }
+        if (auto desc = metadata.getDescription()) {
+            addField(*desc, 0.02);
+        }
+        m_indices.insert({ mod, m_entries.size() });
+        m_entries.push_back(std::move(entry));
+    }
+    m_query.clear();
+    m_candidates.clear();
+    m_scores.clear();
+}
+
+void ModSearchIndex::search(std::string const& query) {
+    auto queryChars = CharSet(query);
+    // The fuzzy matcher only matches if the query is a subsequence of the 
+    // text, so if the previous query is a subsequence of this one, anything 
+    // this one matches the previous one matched too
+    bool incremental = !m_query.empty() && fts::fuzzy_match_simple(m_query.c_str(), query.c_str());
+
+    std::vector<size_t> candidates;
+    m_scores.assign(m_entries.size(), std::nullopt);
+    auto check = [&](size_t index) {
+        auto const& entry = m_entries[index];
+        if (!entry.chars.contains(queryChars)) {
+            return;
+        }
+        bool matched = false;
+        double weighted = 0;
+        for (auto const& field : entry.fields) {
+            if (field.chars.contains(queryChars)) {
+                matched |= weightedFuzzyMatch(field.text, query, field.weight, weighted);
+            }
+        }
+        if (matched) {
+            candidates.push_back(index);
+            if (weighted >= 2) {
+                m_scores[index] = weighted;
+            }
+        }
+    };
+    if (incremental) {
+        for (auto index : m_candidates) {
+            check(index);
+        }
     }
-    if (auto details = metadata.getDetails()) {
-        addToList |= weightedFuzzyMatch(*details, kw, 0.005, weighted);
+    else {
+        for (size_t index = 0; index < m_entries.size(); index += 1) {
+            check(index);
+        }
     }
-    if (auto desc = metadata.getDescription()) {
-        addToList |= weightedFuzzyMatch(*desc, kw, 0.02, weighted);
+    m_candidates = std::move(candidates);
+    m_query = query;
+}
+
+std::optional<double> ModSearchIndex::match(Mod* mod, std::string const& query) {
+    std::unique_lock lock(m_mutex);
+    if (query != m_query || m_scores.size() != m_entries.size()) {
+        this->search(query);
     }
-    if (weighted < 2) {
-        addToList = false;
+    auto it = m_indices.find(mod);
+    if (it == m_indices.end()) {
+        return std::nullopt;
     }
-    return addToList;
+    return m_scores[it->second];
 }
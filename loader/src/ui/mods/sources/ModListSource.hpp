@@ -4,6 +4,7 @@
 #include <Geode/utils/string.hpp>
 #include <server/Server.hpp>
 #include "../list/ModItem.hpp"
+#include <mutex>
 
 using namespace geode::prelude;
 
@@ -39,7 +40,8 @@ public:
         LoadPageError(auto msg, auto details) : message(msg), details(details) {}
     };
 
-    using Page = std::vector<Ref<ModItem>>;
+    // Pages only hold the mods; ModList creates items for the ones in view
+    using Page = std::vector<ModSource>;
     using PageLoadTask = Task<Result<Page, LoadPageError>, std::optional<uint8_t>>;
 
     struct ProvidedMods {
@@ -198,11 +200,77 @@ public:
 };
 
 bool weightedFuzzyMatch(std::string const& str, std::string const& kw, double weight, double& out);
-bool modFuzzyMatch(ModMetadata const& metadata, std::string const& kw, double& out);
+
+// Search index over the metadata of installed mods, so searching doesn't 
+// have to go through every mod's metadata on every keystroke
+class ModSearchIndex final {
+private:
+    // Set of (lower-cased ASCII) characters in a string; a query can only 
+    // fuzzy match a string that contains all of its characters
+    class CharSet final {
+        uint64_t m_bits[2] = { 0, 0 };
+
+    public:
+        CharSet() = default;
+        CharSet(std::string const& str);
+
+        CharSet& operator|=(CharSet const& other);
+        bool contains(CharSet const& other) const;
+    };
+
+    struct Field {
+        std::string text;
+        double weight;
+        CharSet chars;
+    };
+    struct Entry {
+        Mod* mod;
+        VersionInfo version;
+        std::vector<Field> fields;
+        CharSet chars;
+    };
+
+    std::mutex m_mutex;
+    std::vector<Entry> m_entries;
+    std::unordered_map<Mod*, size_t> m_indices;
+    std::string m_query;
+    // Entries that matched m_query at all, no matter the score. A query that 
+    // contains m_query as a subsequence (like it does after typing another 
+    // letter) can only match these
+    std::vector<size_t> m_candidates;
+    // Score of each entry for m_query, if it was good enough to count
+    std::vector<std::optional<double>> m_scores;
+
+    ModSearchIndex() = default;
+
+    void search(std::string const& query);
+
+public:
+    static ModSearchIndex& get();
+
+    /**
+     * Rebuild the index if mods have been installed, removed or updated 
+     * since it was last built
+     */
+    void refresh();
+
+    /**
+     * Get the weighted score of an installed mod for a search query, or 
+     * nullopt if it doesn't match
+     */
+    std::optional<double> match(Mod* mod, std::string const& query);
+};
 
 template <std::derived_from<LocalModsQueryBase> Query>
 void filterModsWithLocalQuery(ModListSource::ProvidedMods& mods, Query const& query) {
-    std::vector<std::pair<ModSource, double>> filtered;
+    struct Filtered {
+        ModSource src;
+        double score;
+        // Sort keys are fetched once up front since getMetadata() copies
+        bool outdated;
+        std::string name;
+    };
+    std::vector<Filtered> filtered;
 
     // Filter installed mods based on query
     // TODO: maybe skip fuzzy matching altogether if query is empty?
@@ -227,27 +295,28 @@ void filterModsWithLocalQuery(ModListSource::ProvidedMods& mods, Query const& qu
             addToList = query.queryCheck(src, weighted);
         }
         if (addToList) {
-            filtered.push_back({ src, weighted });
+            auto metadata = src.getMetadata();
+            filtered.push_back(Filtered {
+                .src = src,
+                .score = weighted,
+                .outdated = metadata.checkTargetVersions().isErr(),
+                .name = metadata.getName(),
+            });
         }
     }
 
     // Sort list based on score
-    std::sort(filtered.begin(), filtered.end(), [](auto a, auto b) {
+    std::sort(filtered.begin(), filtered.end(), [](Filtered const& a, Filtered const& b) {
         // Sort primarily by score
-        if (a.second != b.second) {
-            return a.second > b.second;
+        if (a.score != b.score) {
+            return a.score > b.score;
         }
         // Make sure outdated mods are always last by default
-        auto aIsOutdated = a.first.getMetadata().checkTargetVersions().isErr();
-        auto bIsOutdated = b.first.getMetadata().checkTargetVersions().isErr();
-        if (aIsOutdated != bIsOutdated) {
-            return !aIsOutdated;
+        if (a.outdated != b.outdated) {
+            return !a.outdated;
         }
         // Fallback sort alphabetically
-        return utils::string::caseInsensitiveCompare(
-            a.first.getMetadata().getName(),
-            b.first.getMetadata().getName()
-        ) == std::strong_ordering::less;
+        return utils::string::caseInsensitiveCompare(a.name, b.name) == std::strong_ordering::less;
     });
 
     mods.mods.clear();
@@ -257,7 +326,7 @@ void filterModsWithLocalQuery(ModListSource::ProvidedMods& mods, Query const& qu
         i < filtered.size() && i < (query.page + 1) * query.pageSize;
         i += 1
     ) {
-        mods.mods.push_back(filtered.at(i).first);
+        mods.mods.push_back(std::move(filtered.at(i).src));
     }
     
     mods.totalModCount = filtered.size();
@@ -6,6 +6,7 @@
 #include <Geode/ui/BasedButtonSprite.hpp>
 #include <Geode/utils/web.hpp>
 #include <server/Server.hpp>
+#include <utils/WebCache.hpp>
 #include "../sources/ModListSource.hpp"
 
 using namespace geode::prelude;
@@ -17,6 +18,7 @@ protected:
     CCLabelBMFont* m_rawTaskState;
     CCMenuItemSpriteExtra* m_cancelTaskBtn;
     CCMenuItemSpriteExtra* m_cancelServerTaskBtn;
+    CCLabelBMFont* m_cacheStatsLabel;
     EventListener<web::WebTask> m_rawListener;
     EventListener<StrTask> m_strListener;
     EventListener<server::ServerRequest<server::ServerModsList>> m_serListener;
@@ -77,6 +79,19 @@ protected:
         );
         m_buttonMenu->addChildAtPosition(clearServerCacheBtn, Anchor::Center, ccp(0, -70));
 
+        auto cacheStatsSpr = ButtonSprite::create(
+            "Cache Stats", "bigFont.fnt", "GJ_button_01.png", .8f
+        );
+        cacheStatsSpr->setScale(.5f);
+        auto cacheStatsBtn = CCMenuItemSpriteExtra::create(
+            cacheStatsSpr, this, menu_selector(GUITestPopup::onServerCacheStats)
+        );
+        m_buttonMenu->addChildAtPosition(cacheStatsBtn, Anchor::Center, ccp(0, -95));
+
+        m_cacheStatsLabel = CCLabelBMFont::create("", "bigFont.fnt");
+        m_cacheStatsLabel->setScale(.3f);
+        m_mainLayer->addChildAtPosition(m_cacheStatsLabel, Anchor::Center, ccp(0, -118));
+
         m_rawListener.bind(this, &GUITestPopup::onRawTask);
         m_strListener.bind(this, &GUITestPopup::onStrTask);
         m_serListener.bind(this, &GUITestPopup::onServerTask);
@@ -159,6 +174,23 @@ protected:
     void onServerCacheClear(CCObject*) {
         server::clearServerCaches(true);
         clearAllModListSourceCaches();
+        web::WebCache::get().clear();
+    }
+    void onServerCacheStats(CCObject*) {
+        size_t hits = 0, misses = 0, size = 0;
+        for (auto const& stats : server::getServerCacheStats()) {
+            log::info(
+                "{}: {}/{} entries, {}/{} bytes, {} hits, {} misses, {} evictions",
+                stats.name, stats.entries, stats.entryLimit, stats.size, stats.sizeLimit,
+                stats.hits, stats.misses, stats.evictions
+            );
+            hits += stats.hits;
+            misses += stats.misses;
+            size += stats.size;
+        }
+        m_cacheStatsLabel->setString(fmt::format(
+            "{} hits, {} misses, {} KB", hits, misses, size / 1024
+        ).c_str());
     }
 
 public:
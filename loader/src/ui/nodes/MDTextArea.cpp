@@ -14,6 +14,8 @@
 #include <Geode/utils/string.hpp>
 #include <md4c.h>
 #include <charconv>
+#include <list>
+#include <mutex>
 #include <Geode/loader/Log.hpp>
 #include <Geode/ui/GeodeUI.hpp>
 #include <server/Server.hpp>
@@ -151,10 +153,6 @@ bool MDTextArea::init(std::string const& str, CCSize const& size) {
     return true;
 }
 
-MDTextArea::~MDTextArea() {
-    CC_SAFE_RELEASE(m_renderer);
-}
-
 class BreakLine : public CCNode {
 protected:
     void draw() override {
@@ -240,30 +238,200 @@ void MDTextArea::FLAlert_Clicked(FLAlertLayer* layer, bool btn) {
     }
 }
 
+// Markdown parsed into the sequence of md4c callbacks it produces, so it can
+// be laid out again (for example at a different width) without parsing it
+// again. Only depends on the text, so it can be built on any thread
+struct MDDocument {
+    enum class EventKind {
+        EnterBlock,
+        LeaveBlock,
+        EnterSpan,
+        LeaveSpan,
+        Text,
+    };
+
+    struct Event {
+        EventKind kind;
+        // MD_BLOCKTYPE, MD_SPANTYPE or MD_TEXTTYPE depending on kind
+        int type;
+        // Heading level
+        unsigned level = 0;
+        // Text, or the target of a link or image span
+        std::string text;
+    };
+
+    size_t hash;
+    std::string source;
+    std::vector<Event> events;
+    // Index of the first event of each top-level block
+    std::vector<size_t> blocks;
+    bool failed = false;
+};
+
 struct MDParser {
-    static std::string s_lastLink;
-    static std::string s_lastImage;
-    static bool s_isOrderedList;
-    static bool s_isCodeBlock;
-    static float s_codeStart;
-    static size_t s_orderedListNum;
-    static std::vector<TextRenderer::Label> s_codeSpans;
-    static bool s_breakListLine;
-
-    static int parseText(MD_TEXTTYPE type, MD_CHAR const* rawText, MD_SIZE size, void* mdtextarea) {
-        auto textarea = static_cast<MDTextArea*>(mdtextarea);
-        auto renderer = textarea->m_renderer;
-        auto text = std::string(rawText, size);
+    static constexpr size_t CACHE_SIZE = 16;
+
+    class Layout;
+
+    MDDocument m_document;
+    size_t m_depth = 0;
+
+    void push(MDDocument::EventKind kind, int type, unsigned level = 0, std::string text = "") {
+        m_document.events.push_back({
+            .kind = kind,
+            .type = type,
+            .level = level,
+            .text = std::move(text),
+        });
+    }
+
+    static int parseText(MD_TEXTTYPE type, MD_CHAR const* rawText, MD_SIZE size, void* userdata) {
+        auto parser = static_cast<MDParser*>(userdata);
+        parser->push(MDDocument::EventKind::Text, type, 0, std::string(rawText, size));
+        return 0;
+    }
+
+    static int enterBlock(MD_BLOCKTYPE type, void* detail, void* userdata) {
+        auto parser = static_cast<MDParser*>(userdata);
+        if (type == MD_BLOCKTYPE::MD_BLOCK_DOC) return 0;
+        if (parser->m_depth++ == 0) {
+            parser->m_document.blocks.push_back(parser->m_document.events.size());
+        }
+        unsigned level = 0;
+        if (type == MD_BLOCKTYPE::MD_BLOCK_H) {
+            level = static_cast<MD_BLOCK_H_DETAIL*>(detail)->level;
+        }
+        parser->push(MDDocument::EventKind::EnterBlock, type, level);
+        return 0;
+    }
+
+    static int leaveBlock(MD_BLOCKTYPE type, void* detail, void* userdata) {
+        auto parser = static_cast<MDParser*>(userdata);
+        if (type == MD_BLOCKTYPE::MD_BLOCK_DOC) return 0;
+        parser->m_depth -= 1;
+        unsigned level = 0;
+        if (type == MD_BLOCKTYPE::MD_BLOCK_H) {
+            level = static_cast<MD_BLOCK_H_DETAIL*>(detail)->level;
+        }
+        parser->push(MDDocument::EventKind::LeaveBlock, type, level);
+        return 0;
+    }
+
+    static int enterSpan(MD_SPANTYPE type, void* detail, void* userdata) {
+        auto parser = static_cast<MDParser*>(userdata);
+        std::string target;
+        if (type == MD_SPANTYPE::MD_SPAN_IMG) {
+            auto adetail = static_cast<MD_SPAN_IMG_DETAIL*>(detail);
+            target = std::string(adetail->src.text, adetail->src.size);
+        }
+        else if (type == MD_SPANTYPE::MD_SPAN_A) {
+            auto adetail = static_cast<MD_SPAN_A_DETAIL*>(detail);
+            target = std::string(adetail->href.text, adetail->href.size);
+        }
+        parser->push(MDDocument::EventKind::EnterSpan, type, 0, std::move(target));
+        return 0;
+    }
+
+    static int leaveSpan(MD_SPANTYPE type, void* detail, void* userdata) {
+        auto parser = static_cast<MDParser*>(userdata);
+        parser->push(MDDocument::EventKind::LeaveSpan, type);
+        return 0;
+    }
+
+    /**
+     * Parse markdown, or get it from the cache of recently parsed documents.
+     * Thread-safe
+     */
+    static std::shared_ptr<MDDocument const> parse(std::string const& text) {
+        static std::mutex mutex;
+        static std::list<std::shared_ptr<MDDocument const>> cache;
+
+        auto hash = std::hash<std::string>()(text);
+        {
+            std::unique_lock lock(mutex);
+            for (auto it = cache.begin(); it != cache.end(); it++) {
+                if ((*it)->hash == hash && (*it)->source == text) {
+                    cache.splice(cache.begin(), cache, it);
+                    return cache.front();
+                }
+            }
+        }
+
+        MDParser parser;
+        parser.m_document.hash = hash;
+        parser.m_document.source = text;
+
+        MD_PARSER mdParser;
+
+        mdParser.abi_version = 0;
+        mdParser.flags = MD_FLAG_UNDERLINE | MD_FLAG_STRIKETHROUGH | MD_FLAG_PERMISSIVEURLAUTOLINKS |
+            MD_FLAG_PERMISSIVEWWWAUTOLINKS;
+
+        mdParser.text = &MDParser::parseText;
+        mdParser.enter_block = &MDParser::enterBlock;
+        mdParser.leave_block = &MDParser::leaveBlock;
+        mdParser.enter_span = &MDParser::enterSpan;
+        mdParser.leave_span = &MDParser::leaveSpan;
+        mdParser.debug_log = nullptr;
+        mdParser.syntax = nullptr;
+
+        parser.m_document.failed = md_parse(text.c_str(), text.size(), &mdParser, &parser) != 0;
+
+        auto document = std::make_shared<MDDocument const>(std::move(parser.m_document));
+        std::unique_lock lock(mutex);
+        cache.push_front(document);
+        if (cache.size() > CACHE_SIZE) {
+            cache.pop_back();
+        }
+        return document;
+    }
+};
+
+// Lays out a parsed document into its textarea. Top-level blocks are laid out 
+// in order only as far as the textarea has been scrolled, and the rest is 
+// continued on later frames by this node, which is added to the textarea 
+// until it's done. Nested in MDParser for its access to MDTextArea
+class MDParser::Layout final : public CCNode {
+public:
+    MDTextArea* m_textarea;
+    TextRenderer* m_renderer;
+    std::shared_ptr<MDDocument const> m_document;
+    size_t m_nextBlock = 0;
+
+    std::string m_lastLink;
+    std::string m_lastImage;
+    bool m_isOrderedList = false;
+    bool m_isCodeBlock = false;
+    float m_codeStart = 0;
+    size_t m_orderedListNum = 0;
+    std::vector<TextRenderer::Label> m_codeSpans;
+    bool m_breakListLine = false;
+
+    Layout(MDTextArea* textarea, std::shared_ptr<MDDocument const> document)
+      : m_textarea(textarea), m_renderer(textarea->m_renderer), m_document(std::move(document)) {}
+
+    static Layout* create(MDTextArea* textarea, std::shared_ptr<MDDocument const> document) {
+        auto ret = new Layout(textarea, std::move(document));
+        if (ret->init()) {
+            ret->autorelease();
+            return ret;
+        }
+        delete ret;
+        return nullptr;
+    }
+
+    void text(MD_TEXTTYPE type, std::string const& text) {
+        auto renderer = m_renderer;
         switch (type) {
             case MD_TEXTTYPE::MD_TEXT_CODE:
                 {
                     auto rendered = renderer->renderString(text);
-                    if (!s_isCodeBlock) {
+                    if (!m_isCodeBlock) {
                         // code span BGs need to be rendered after all
                         // rendering is done since the position of the
                         // rendered labels may change after alignments
                         // are adjusted
-                        ranges::push(s_codeSpans, rendered);
+                        ranges::push(m_codeSpans, rendered);
                     }
                 }
                 break;
@@ -282,26 +450,26 @@ struct MDParser {
 
             case MD_TEXTTYPE::MD_TEXT_NORMAL:
                 {
-                    if (s_lastLink.size()) {
+                    if (m_lastLink.size()) {
                         renderer->pushColor(g_linkColor);
                         renderer->pushDecoFlags(TextDecorationUnderline);
                         auto rendered = renderer->renderStringInteractive(
-                            text, textarea,
-                            utils::string::startsWith(s_lastLink, "user:")
+                            text, m_textarea,
+                            utils::string::startsWith(m_lastLink, "user:")
                                 ? menu_selector(MDTextArea::onGDProfile)
-                                : utils::string::startsWith(s_lastLink, "level:")
+                                : utils::string::startsWith(m_lastLink, "level:")
                                     ? menu_selector(MDTextArea::onGDLevel)
-                                    : utils::string::startsWith(s_lastLink, "mod:")
+                                    : utils::string::startsWith(m_lastLink, "mod:")
                                         ? menu_selector(MDTextArea::onGeodeMod)
                                         : menu_selector(MDTextArea::onLink)
                         );
                         for (auto const& label : rendered) {
-                            label.m_node->setUserObject(CCString::create(s_lastLink));
+                            label.m_node->setUserObject(CCString::create(m_lastLink));
                         }
                         renderer->popDecoFlags();
                         renderer->popColor();
                     }
-                    else if (!s_lastImage.empty()) {
+                    else if (!m_lastImage.empty()) {
                         bool isFrame = false;
 
                         const auto splitOnce = [](const std::string& str, char delim) -> std::pair<std::string, std::string> {
@@ -314,8 +482,8 @@ struct MDParser {
 
                         // key value pair of arguments
                         std::vector<std::pair<std::string, std::string>> imgArguments;
-                        auto split = splitOnce(s_lastImage, '?');
-                        s_lastImage = split.first;
+                        auto split = splitOnce(m_lastImage, '?');
+                        m_lastImage = split.first;
 
                         imgArguments = ranges::map<decltype(imgArguments)>(utils::string::split(split.second, "&"), [&](auto str) {
                             return splitOnce(str, '=');
@@ -346,16 +514,16 @@ struct MDParser {
                             }
                         }
 
-                        if (utils::string::startsWith(s_lastImage, "frame:")) {
-                            s_lastImage = s_lastImage.substr(s_lastImage.find(":") + 1);
+                        if (utils::string::startsWith(m_lastImage, "frame:")) {
+                            m_lastImage = m_lastImage.substr(m_lastImage.find(":") + 1);
                             isFrame = true;
                         }
                         CCSprite* spr = nullptr;
                         if (isFrame) {
-                            spr = CCSprite::createWithSpriteFrameName(s_lastImage.c_str());
+                            spr = CCSprite::createWithSpriteFrameName(m_lastImage.c_str());
                         }
                         else {
-                            spr = CCSprite::create(s_lastImage.c_str());
+                            spr = CCSprite::create(m_lastImage.c_str());
                         }
                         if (spr && spr->getUserObject("geode.texture-loader/fallback") == nullptr) {
                             spr->setScale(spriteScale);
@@ -373,7 +541,7 @@ struct MDParser {
                         else {
                             renderer->renderString(text);
                         }
-                        s_lastImage = "";
+                        m_lastImage = "";
                     }
                     else {
                         renderer->renderString(text);
@@ -419,23 +587,15 @@ struct MDParser {
                 }
                 break;
         }
-        return 0;
     }
 
-    static int enterBlock(MD_BLOCKTYPE type, void* detail, void* mdtextarea) {
-        auto textarea = static_cast<MDTextArea*>(mdtextarea);
-        auto renderer = textarea->m_renderer;
+    void enterBlock(MD_BLOCKTYPE type, unsigned level) {
+        auto renderer = m_renderer;
         switch (type) {
-            case MD_BLOCKTYPE::MD_BLOCK_DOC:
-                {
-                }
-                break;
-
             case MD_BLOCKTYPE::MD_BLOCK_H:
                 {
-                    auto hdetail = static_cast<MD_BLOCK_H_DETAIL*>(detail);
                     renderer->pushStyleFlags(TextStyleBold);
-                    switch (hdetail->level) {
+                    switch (level) {
                         case 1: renderer->pushScale(g_fontScale * 2.f); break;
                         case 2: renderer->pushScale(g_fontScale * 1.5f); break;
                         case 3: renderer->pushScale(g_fontScale * 1.17f); break;
@@ -444,7 +604,7 @@ struct MDParser {
                         default:
                         case 6: renderer->pushScale(g_fontScale * .67f); break;
                     }
-                    // switch (hdetail->level) {
+                    // switch (level) {
                     //     case 3: renderer->pushCaps(TextCapitalization::AllUpper); break;
                     // }
                 }
@@ -459,11 +619,11 @@ struct MDParser {
             case MD_BLOCKTYPE::MD_BLOCK_OL:
                 {
                     renderer->pushIndent(g_indent);
-                    s_isOrderedList = type == MD_BLOCKTYPE::MD_BLOCK_OL;
-                    s_orderedListNum = 0;
-                    if (s_breakListLine) {
+                    m_isOrderedList = type == MD_BLOCKTYPE::MD_BLOCK_OL;
+                    m_orderedListNum = 0;
+                    if (m_breakListLine) {
                         renderer->breakLine();
-                        s_breakListLine = false;
+                        m_breakListLine = false;
                     }
                 }
                 break;
@@ -471,35 +631,34 @@ struct MDParser {
             case MD_BLOCKTYPE::MD_BLOCK_HR:
                 {
                     renderer->breakLine(g_paragraphPadding / 2);
-                    renderer->renderNode(BreakLine::create(textarea->m_size.width));
+                    renderer->renderNode(BreakLine::create(m_textarea->m_size.width));
                     renderer->breakLine(g_paragraphPadding);
                 }
                 break;
 
             case MD_BLOCKTYPE::MD_BLOCK_LI:
                 {
-                    if (s_breakListLine) {
+                    if (m_breakListLine) {
                         renderer->breakLine();
-                        s_breakListLine = false;
+                        m_breakListLine = false;
                     }
                     renderer->pushOpacity(renderer->getCurrentOpacity() / 2);
-                    auto lidetail = static_cast<MD_BLOCK_LI_DETAIL*>(detail);
-                    if (s_isOrderedList) {
-                        s_orderedListNum++;
-                        renderer->renderString(std::to_string(s_orderedListNum) + ". ");
+                    if (m_isOrderedList) {
+                        m_orderedListNum++;
+                        renderer->renderString(std::to_string(m_orderedListNum) + ". ");
                     }
                     else {
                         renderer->renderString("• ");
                     }
                     renderer->popOpacity();
-                    s_breakListLine = true;
+                    m_breakListLine = true;
                 }
                 break;
 
             case MD_BLOCKTYPE::MD_BLOCK_CODE:
                 {
-                    s_isCodeBlock = true;
-                    s_codeStart = renderer->getCursorPos().y;
+                    m_isCodeBlock = true;
+                    m_codeStart = renderer->getCursorPos().y;
                     renderer->pushFont(g_mdMonoFont);
                     renderer->pushIndent(g_codeBlockIndent);
                     renderer->pushWrapOffset(g_codeBlockIndent);
@@ -512,30 +671,22 @@ struct MDParser {
                 }
                 break;
         }
-        return 0;
     }
 
-    static int leaveBlock(MD_BLOCKTYPE type, void* detail, void* mdtextarea) {
-        auto textarea = static_cast<MDTextArea*>(mdtextarea);
-        auto renderer = textarea->m_renderer;
+    void leaveBlock(MD_BLOCKTYPE type, unsigned level) {
+        auto renderer = m_renderer;
         switch (type) {
-            case MD_BLOCKTYPE::MD_BLOCK_DOC:
-                {
-                }
-                break;
-
             case MD_BLOCKTYPE::MD_BLOCK_H:
                 {
-                    auto hdetail = static_cast<MD_BLOCK_H_DETAIL*>(detail);
                     renderer->breakLine();
-                    if (hdetail->level == 1) {
+                    if (level == 1) {
                         renderer->breakLine(g_paragraphPadding / 2);
-                        renderer->renderNode(BreakLine::create(textarea->m_size.width));
+                        renderer->renderNode(BreakLine::create(m_textarea->m_size.width));
                     }
                     renderer->breakLine(g_paragraphPadding);
                     renderer->popScale();
                     renderer->popStyleFlags();
-                    // switch (hdetail->level) {
+                    // switch (level) {
                     //     case 3: renderer->popCaps(); break;
                     // }
                 }
@@ -552,9 +703,9 @@ struct MDParser {
             case MD_BLOCKTYPE::MD_BLOCK_UL:
                 {
                     renderer->popIndent();
-                    if (s_breakListLine) {
+                    if (m_breakListLine) {
                         renderer->breakLine();
-                        s_breakListLine = false;
+                        m_breakListLine = false;
                     }
                     if (renderer->getCurrentIndent() == 0) {
                         renderer->breakLine();
@@ -568,9 +719,9 @@ struct MDParser {
 
                     auto pad = g_codeBlockIndent / 1.5f;
 
-                    CCSize size { textarea->m_size.width - renderer->getCurrentIndent() -
+                    CCSize size { m_textarea->m_size.width - renderer->getCurrentIndent() -
                                       renderer->getCurrentWrapOffset() + pad * 2,
-                                  s_codeStart - codeEnd + pad * 2 };
+                                  m_codeStart - codeEnd + pad * 2 };
 
                     auto bg =
                         CCScale9Sprite::create("square02b_001.png", { 0.0f, 0.0f, 80.0f, 80.0f });
@@ -585,11 +736,11 @@ struct MDParser {
                         // to fit the Ubuntu font very neatly.
                         // idk if it works the same for other
                         // fonts
-                        s_codeStart - 2.f + pad - size.height / 2
+                        m_codeStart - 2.f + pad - size.height / 2
                     );
                     bg->setAnchorPoint({ .5f, .5f });
                     bg->setZOrder(-1);
-                    textarea->m_content->addChild(bg);
+                    m_textarea->m_content->addChild(bg);
 
                     renderer->popWrapOffset();
                     renderer->popIndent();
@@ -615,11 +766,10 @@ struct MDParser {
                 }
                 break;
         }
-        return 0;
     }
 
-    static int enterSpan(MD_SPANTYPE type, void* detail, void* mdtextarea) {
-        auto renderer = static_cast<MDTextArea*>(mdtextarea)->m_renderer;
+    void enterSpan(MD_SPANTYPE type, std::string const& target) {
+        auto renderer = m_renderer;
         switch (type) {
             case MD_SPANTYPE::MD_SPAN_STRONG:
                 {
@@ -647,21 +797,19 @@ struct MDParser {
 
             case MD_SPANTYPE::MD_SPAN_IMG:
                 {
-                    auto adetail = static_cast<MD_SPAN_IMG_DETAIL*>(detail);
-                    s_lastImage = std::string(adetail->src.text, adetail->src.size);
+                    m_lastImage = target;
                 }
                 break;
 
             case MD_SPANTYPE::MD_SPAN_A:
                 {
-                    auto adetail = static_cast<MD_SPAN_A_DETAIL*>(detail);
-                    s_lastLink = std::string(adetail->href.text, adetail->href.size);
+                    m_lastLink = target;
                 }
                 break;
 
             case MD_SPANTYPE::MD_SPAN_CODE:
                 {
-                    s_isCodeBlock = false;
+                    m_isCodeBlock = false;
                     renderer->pushFont(g_mdMonoFont);
                 }
                 break;
@@ -672,11 +820,10 @@ struct MDParser {
                 }
                 break;
         }
-        return 0;
     }
 
-    static int leaveSpan(MD_SPANTYPE type, void* detail, void* mdtextarea) {
-        auto renderer = static_cast<MDTextArea*>(mdtextarea)->m_renderer;
+    void leaveSpan(MD_SPANTYPE type) {
+        auto renderer = m_renderer;
         switch (type) {
             case MD_SPANTYPE::MD_SPAN_STRONG:
                 {
@@ -704,13 +851,13 @@ struct MDParser {
 
             case MD_SPANTYPE::MD_SPAN_A:
                 {
-                    s_lastLink = "";
+                    m_lastLink = "";
                 }
                 break;
 
             case MD_SPANTYPE::MD_SPAN_IMG:
                 {
-                    s_lastImage = "";
+                    m_lastImage = "";
                 }
                 break;
 
@@ -726,20 +873,143 @@ struct MDParser {
                 }
                 break;
         }
-        return 0;
+    }
+
+    void replay(MDDocument::Event const& event) {
+        switch (event.kind) {
+            case MDDocument::EventKind::EnterBlock:
+                this->enterBlock(static_cast<MD_BLOCKTYPE>(event.type), event.level);
+                break;
+            case MDDocument::EventKind::LeaveBlock:
+                this->leaveBlock(static_cast<MD_BLOCKTYPE>(event.type), event.level);
+                break;
+            case MDDocument::EventKind::EnterSpan:
+                this->enterSpan(static_cast<MD_SPANTYPE>(event.type), event.text);
+                break;
+            case MDDocument::EventKind::LeaveSpan:
+                this->leaveSpan(static_cast<MD_SPANTYPE>(event.type));
+                break;
+            case MDDocument::EventKind::Text:
+                this->text(static_cast<MD_TEXTTYPE>(event.type), event.text);
+                break;
+        }
+    }
+
+    void addCodeSpanBGs() {
+        for (auto& render : m_codeSpans) {
+            auto bg = CCScale9Sprite::create("square02b_001.png", { 0.0f, 0.0f, 80.0f, 80.0f });
+            bg->setScale(.125f);
+            bg->setColor({ 0, 0, 0 });
+            bg->setOpacity(75);
+            bg->setContentSize(render.m_node->getScaledContentSize() * 8 + CCSize { 20.f, .0f });
+            bg->setPosition(
+                render.m_node->getPositionX() - 2.5f * (.5f - render.m_node->getAnchorPoint().x),
+                render.m_node->getPositionY() - .5f
+            );
+            bg->setAnchorPoint(render.m_node->getAnchorPoint());
+            bg->setZOrder(-1);
+            m_textarea->m_content->addChild(bg);
+            // i know what you're thinking.
+            // my brother in christ, what the hell is this?
+            // where did this magical + 1.5f come from?
+            // the reason is that if you remove them, code
+            // spans are slightly offset and it triggers my
+            // OCD.
+            render.m_node->setPositionY(render.m_node->getPositionY() + 1.5f);
+        }
+        m_codeSpans.clear();
+    }
+
+    bool isDone() const {
+        return m_nextBlock >= m_document->blocks.size();
+    }
+
+    void layoutNextBlock() {
+        // Keep going until the last line is finished, since code span 
+        // backgrounds can only be placed once the line has been aligned
+        do {
+            auto begin = m_document->blocks[m_nextBlock];
+            m_nextBlock += 1;
+            auto end = this->isDone() ? m_document->events.size() : m_document->blocks[m_nextBlock];
+            for (auto i = begin; i < end; i++) {
+                this->replay(m_document->events[i]);
+            }
+        }
+        while (!this->isDone() && m_renderer->getCursorPos().x != 0.f);
+        this->addCodeSpanBGs();
+    }
+
+    // Resize the scrollable area to fit the content, keeping the same part of 
+    // the content in view
+    void updateScrollSize(float offset) {
+        auto content = m_textarea->m_content;
+        auto contentLayer = m_textarea->m_scrollLayer->m_contentLayer;
+        auto scrolled = contentLayer->getContentHeight() + contentLayer->getPositionY();
+        if (content->getContentSize().height > m_textarea->m_size.height) {
+            // Generate bottom padding
+            contentLayer->setContentSize(content->getContentSize() + CCSize { 0.f, 12.5 });
+            content->setPositionY(10.f + offset);
+        } else {
+            contentLayer->setContentSize(content->getContentSize());
+            content->setPositionY(-2.5f + offset);
+        }
+        contentLayer->setPositionY(scrolled - contentLayer->getContentHeight());
+    }
+
+    /**
+     * Lay out blocks until the content reaches the given distance from the 
+     * top, or at least one block if there are any left
+     * @returns True if the whole document has been laid out
+     */
+    bool layoutUntil(float depth) {
+        while (!this->isDone()) {
+            this->layoutNextBlock();
+            if (-m_renderer->getCursorPos().y >= depth) break;
+        }
+        if (this->isDone()) {
+            if (m_document->failed) {
+                m_renderer->renderString("Error parsing Markdown");
+            }
+            this->addCodeSpanBGs();
+            m_renderer->end();
+            this->updateScrollSize(0.f);
+            return true;
+        }
+        // TextRenderer only moves the content into place once it's done, so 
+        // until then the content is offset to match
+        auto content = m_textarea->m_content;
+        auto coverage = calculateChildCoverage(content);
+        content->setContentSize({
+            std::max(coverage.size.width - coverage.origin.x, m_textarea->m_size.width),
+            std::max(coverage.size.height - coverage.origin.y, m_textarea->m_size.height),
+        });
+        this->updateScrollSize(content->getContentSize().height - coverage.size.height);
+        return false;
+    }
+
+    void update(float) override {
+        auto contentLayer = m_textarea->m_scrollLayer->m_contentLayer;
+        auto scrolled = contentLayer->getContentHeight() + contentLayer->getPositionY();
+        if (this->layoutUntil(scrolled + m_textarea->m_size.height)) {
+            this->unscheduleUpdate();
+            this->removeFromParent();
+        }
     }
 };
 
-std::string MDParser::s_lastLink = "";
-std::string MDParser::s_lastImage = "";
-bool MDParser::s_isOrderedList = false;
-size_t MDParser::s_orderedListNum = 0;
-bool MDParser::s_isCodeBlock = false;
-float MDParser::s_codeStart = 0;
-decltype(MDParser::s_codeSpans) MDParser::s_codeSpans = {};
-bool MDParser::s_breakListLine = false;
+MDTextArea::~MDTextArea() {
+    CC_SAFE_RELEASE(m_renderer);
+}
 
 void MDTextArea::updateLabel() {
+    if (auto layout = this->getChildByType<MDParser::Layout>(0)) {
+        // Abandon the previous unfinished layout
+        m_renderer->end(false);
+        layout->unscheduleUpdate();
+        layout->removeFromParent();
+    }
+    auto layout = MDParser::Layout::create(this, MDParser::parse(m_text));
+
     m_renderer->begin(m_content, CCPointZero, m_size);
 
     m_renderer->pushFont(g_mdFont);
@@ -747,57 +1017,10 @@ void MDTextArea::updateLabel() {
     m_renderer->pushVerticalAlign(TextAlignment::End);
     m_renderer->pushHorizontalAlign(TextAlignment::Begin);
 
-    MD_PARSER parser;
-
-    parser.abi_version = 0;
-    parser.flags = MD_FLAG_UNDERLINE | MD_FLAG_STRIKETHROUGH | MD_FLAG_PERMISSIVEURLAUTOLINKS |
-        MD_FLAG_PERMISSIVEWWWAUTOLINKS;
-
-    parser.text = &MDParser::parseText;
-    parser.enter_block = &MDParser::enterBlock;
-    parser.leave_block = &MDParser::leaveBlock;
-    parser.enter_span = &MDParser::enterSpan;
-    parser.leave_span = &MDParser::leaveSpan;
-    parser.debug_log = nullptr;
-    parser.syntax = nullptr;
-
-    MDParser::s_codeSpans = {};
-
-    if (md_parse(m_text.c_str(), m_text.size(), &parser, this)) {
-        m_renderer->renderString("Error parsing Markdown");
-    }
-
-    for (auto& render : MDParser::s_codeSpans) {
-        auto bg = CCScale9Sprite::create("square02b_001.png", { 0.0f, 0.0f, 80.0f, 80.0f });
-        bg->setScale(.125f);
-        bg->setColor({ 0, 0, 0 });
-        bg->setOpacity(75);
-        bg->setContentSize(render.m_node->getScaledContentSize() * 8 + CCSize { 20.f, .0f });
-        bg->setPosition(
-            render.m_node->getPositionX() - 2.5f * (.5f - render.m_node->getAnchorPoint().x),
-            render.m_node->getPositionY() - .5f
-        );
-        bg->setAnchorPoint(render.m_node->getAnchorPoint());
-        bg->setZOrder(-1);
-        m_content->addChild(bg);
-        // i know what you're thinking.
-        // my brother in christ, what the hell is this?
-        // where did this magical + 1.5f come from?
-        // the reason is that if you remove them, code
-        // spans are slightly offset and it triggers my
-        // OCD.
-        render.m_node->setPositionY(render.m_node->getPositionY() + 1.5f);
-    }
-
-    m_renderer->end();
-
-    if (m_content->getContentSize().height > m_size.height) {
-        // Generate bottom padding
-        m_scrollLayer->m_contentLayer->setContentSize(m_content->getContentSize() + CCSize { 0.f, 12.5 });
-        m_content->setPositionY(10.f);
-    } else {
-        m_scrollLayer->m_contentLayer->setContentSize(m_content->getContentSize());
-        m_content->setPositionY(-2.5f);
+    // Lay out what fits on screen plus one page of scrolling right away
+    if (!layout->layoutUntil(m_size.height * 2)) {
+        this->addChild(layout);
+        layout->scheduleUpdate();
     }
 
     m_scrollLayer->moveToTop();
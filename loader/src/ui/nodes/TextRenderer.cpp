@@ -2,10 +2,121 @@
 #include <Geode/utils/casts.hpp>
 #include <Geode/utils/cocos.hpp>
 #include <Geode/utils/string.hpp>
+#include <algorithm>
+#include <unordered_map>
 
 using namespace geode::prelude;
 using namespace std::string_literals;
 
+namespace {
+    // Glyph advances and kernings of a BMFont, read once per font so text can 
+    // be measured without setting it on a label (which creates a sprite for 
+    // every glyph)
+    class BMFontMetrics final {
+        struct Glyph {
+            short xAdvance;
+            float width;
+        };
+
+        CCBMFontConfiguration* m_config = nullptr;
+        std::unordered_map<unsigned int, Glyph> m_glyphs;
+        std::unordered_map<unsigned int, int> m_kernings;
+        int m_extraKerning = 0;
+        float m_scaleFactor = 1.f;
+        bool m_valid = false;
+
+        BMFontMetrics(CCLabelBMFont* label) : m_config(label->getConfiguration()) {
+            tCCFontDefHashElement* def;
+            tCCFontDefHashElement* tmpDef;
+            HASH_ITER(hh, m_config->m_pFontDefDictionary, def, tmpDef) {
+                m_glyphs.insert({ def->key, Glyph {
+                    .xAdvance = def->fontDef.xAdvance,
+                    .width = def->fontDef.rect.size.width,
+                } });
+            }
+            tCCKerningHashElement* kerning;
+            tCCKerningHashElement* tmpKerning;
+            HASH_ITER(hh, m_config->m_pKerningDictionary, kerning, tmpKerning) {
+                m_kernings.insert({ static_cast<unsigned int>(kerning->key), kerning->amount });
+            }
+            m_extraKerning = label->getExtraKerning();
+            m_scaleFactor = CC_CONTENT_SCALE_FACTOR();
+
+            // Make sure the measurements actually match the label, and if not 
+            // fall back to measuring through the label
+            auto sample = "The quick brown fox jumps over the lazy dog. 0123456789";
+            auto orig = std::string(label->getString());
+            label->setString(sample);
+            auto expected = label->getContentSize().width;
+            label->setString(orig.c_str());
+
+            Cursor cursor;
+            this->advance(cursor, sample);
+            m_valid = std::abs(this->getWidth(cursor) - expected) < .01f;
+            if (!m_valid) {
+                log::debug(
+                    "Glyph metrics of font {} don't match its labels, falling back to measuring labels",
+                    label->getFntFile()
+                );
+            }
+        }
+
+    public:
+        // Measurement state of a line, following CCLabelBMFont::createFontChars
+        struct Cursor {
+            int x = 0;
+            unsigned int longest = 0;
+            Glyph const* last = nullptr;
+            unsigned short prev = static_cast<unsigned short>(-1);
+        };
+
+        static BMFontMetrics const* get(CCLabelBMFont* label) {
+            static std::unordered_map<std::string, std::unique_ptr<BMFontMetrics>> cache;
+            auto key = fmt::format("{}:{}", label->getFntFile(), label->getExtraKerning());
+            auto& metrics = cache[key];
+            // Fonts get reloaded when the texture quality changes
+            if (!metrics || metrics->m_config != label->getConfiguration()) {
+                metrics.reset(new BMFontMetrics(label));
+            }
+            return metrics->m_valid ? metrics.get() : nullptr;
+        }
+
+        void advance(Cursor& cursor, std::string const& text) const {
+            int length = 0;
+            auto str = cc_utf8_to_utf16(text.c_str(), &length);
+            if (!str) return;
+            for (int i = 0; i < length; i += 1) {
+                auto c = str[i];
+                int kerning = 0;
+                if (auto it = m_kernings.find((cursor.prev << 16) | (c & 0xffff)); it != m_kernings.end()) {
+                    kerning = it->second;
+                }
+                auto glyph = m_glyphs.find(c);
+                if (glyph == m_glyphs.end()) continue;
+                cursor.x += glyph->second.xAdvance + kerning + m_extraKerning;
+                cursor.prev = c;
+                if (cursor.longest < cursor.x) {
+                    cursor.longest = cursor.x;
+                }
+                cursor.last = &glyph->second;
+            }
+            delete[] str;
+        }
+
+        // Unscaled content width of a label with the measured text
+        float getWidth(Cursor const& cursor) const {
+            if (!cursor.last) return 0.f;
+            float width = cursor.longest;
+            // Same as labels, make room for the last glyph if it's wider than 
+            // its advance
+            if (cursor.last->xAdvance < cursor.last->width) {
+                width = cursor.longest + cursor.last->width - cursor.last->xAdvance;
+            }
+            return width / m_scaleFactor;
+        }
+    };
+}
+
 bool TextDecorationWrapper::init(
     TextRenderer::Label const& label, int deco, ccColor3B const& color, GLubyte opacity
 ) {
@@ -338,6 +449,15 @@ std::vector<TextRenderer::Label> TextRenderer::renderStringEx(
     Label label;
     bool newLine = true;
 
+    // If the font is a BMFont with known metrics, lines are measured through 
+    // them and the label's string is only set once the line is finished
+    BMFontMetrics const* metrics = nullptr;
+    BMFontMetrics::Cursor lineCursor;
+    std::string lineText;
+    bool lineDirty = false;
+    // Scales from the label up to the rendered node (which may be a wrapper)
+    std::vector<float> lineScales;
+
     auto lastIndent =
         m_indentationStack.size() > 1 ? m_indentationStack.at(m_indentationStack.size() - 1) : .0f;
 
@@ -349,7 +469,8 @@ std::vector<TextRenderer::Label> TextRenderer::renderStringEx(
         // create label through font and add
         // decorations (underline, strikethrough) +
         // buttonize (new word just dropped)
-        label = this->addWrappers(font(style), isButton, target, callback);
+        auto base = font(style);
+        label = this->addWrappers(base, isButton, target, callback);
 
         label.m_node->setScale(scale);
         label.m_node->setPosition(m_cursor);
@@ -357,6 +478,17 @@ std::vector<TextRenderer::Label> TextRenderer::renderStringEx(
         label.m_rgbaProtocol->setColor(color);
         label.m_rgbaProtocol->setOpacity(opacity);
 
+        auto bmFont = typeinfo_cast<CCLabelBMFont*>(base.m_node);
+        metrics = bmFont ? BMFontMetrics::get(bmFont) : nullptr;
+        lineCursor = BMFontMetrics::Cursor();
+        lineText.clear();
+        lineDirty = false;
+        lineScales.clear();
+        for (auto node = base.m_node; node; node = node->getParent()) {
+            lineScales.push_back(node->getScaleX());
+            if (node == label.m_node) break;
+        }
+
         res.push_back(label);
         m_renderedLine.push_back(label.m_node);
         if (addToTarget) {
@@ -366,7 +498,45 @@ std::vector<TextRenderer::Label> TextRenderer::renderStringEx(
         return true;
     };
 
+    auto finishLine = [&]() {
+        if (lineDirty) {
+            label.m_labelProtocol->setString(lineText.c_str());
+            lineDirty = false;
+        }
+    };
+
+    // try to add text to the end of the current line
+    auto render = [&](std::string const& text) -> bool {
+        if (!metrics) {
+            return this->render(text, label.m_node, label.m_labelProtocol);
+        }
+        auto cursor = lineCursor;
+        // Multi-byte characters may have been split by the per-character 
+        // fallback, so those need the whole line decoded again like labels do
+        if (std::any_of(text.begin(), text.end(), [](char c) { return c & 0x80; })) {
+            cursor = BMFontMetrics::Cursor();
+            metrics->advance(cursor, lineText + text);
+        }
+        else {
+            metrics->advance(cursor, text);
+        }
+        if (m_size.width) {
+            auto width = metrics->getWidth(cursor);
+            for (auto s : lineScales) {
+                width *= s;
+            }
+            if (m_cursor.x + width > m_size.width - this->getCurrentWrapOffset()) {
+                return false;
+            }
+        }
+        lineCursor = cursor;
+        lineText += text;
+        lineDirty = true;
+        return true;
+    };
+
     auto nextLine = [&]() -> bool {
+        finishLine();
         this->breakLine(label.m_lineHeight * scale);
         if (!createLabel()) return false;
         newLine = true;
@@ -396,7 +566,7 @@ std::vector<TextRenderer::Label> TextRenderer::renderStringEx(
             }
 
             // try to render at the end of current line
-            if (this->render(word, label.m_node, label.m_labelProtocol)) continue;
+            if (render(word)) continue;
 
             // try to create a new line
             if (!nextLine()) return {};
@@ -405,7 +575,7 @@ std::vector<TextRenderer::Label> TextRenderer::renderStringEx(
             newLine = false;
 
             // try to render on new line
-            if (this->render(word, label.m_node, label.m_labelProtocol)) continue;
+            if (render(word)) continue;
 
             // no need to create a new line as we know
             // the current one has no content and is
@@ -413,7 +583,7 @@ std::vector<TextRenderer::Label> TextRenderer::renderStringEx(
 
             // render character by character
             for (auto& c : word) {
-                if (!this->render(std::string(1, c), label.m_node, label.m_labelProtocol)) {
+                if (!render(std::string(1, c))) {
                     if (!nextLine()) return {};
 
                     if (utils::string::startsWith(word, " ")) word = word.substr(1);
@@ -422,6 +592,7 @@ std::vector<TextRenderer::Label> TextRenderer::renderStringEx(
             }
         }
         // increment cursor position
+        finishLine();
         m_cursor.x += label.m_node->getScaledContentSize().width;
     }
 
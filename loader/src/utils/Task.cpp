@@ -0,0 +1,207 @@
+#include <Geode/utils/Task.hpp>
+#include <Geode/loader/Log.hpp>
+#include <array>
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <thread>
+
+using namespace geode::prelude;
+
+// Shared thread pool that runs the bodies of Task::run and
+// Task::runWithCallback. Jobs queued from a worker go to that worker's own
+// queue, and idle workers steal from the others; jobs from any other thread
+// go to a global queue
+class TaskPool final {
+    static constexpr size_t PRIORITY_COUNT = 3;
+    // How long the queue may go without any job being started while every
+    // worker is busy before a temporary extra thread is started. Task bodies
+    // are allowed to block, so without this a few long-running Tasks could
+    // starve everything else
+    static constexpr auto OVERFLOW_DELAY = std::chrono::milliseconds(100);
+    static constexpr size_t NOT_A_WORKER = static_cast<size_t>(-1);
+
+    using Clock = std::chrono::steady_clock;
+
+    struct Job {
+        std::function<void()> run;
+        Clock::time_point queuedAt;
+    };
+
+    struct Queue {
+        std::mutex mutex;
+        std::array<std::deque<Job>, PRIORITY_COUNT> jobs;
+    };
+
+    static inline thread_local size_t s_workerIndex = NOT_A_WORKER;
+
+    std::vector<std::unique_ptr<Queue>> m_locals;
+    Queue m_global;
+    std::mutex m_sleepMutex;
+    std::condition_variable m_wake;
+    std::atomic_size_t m_queued = 0;
+    std::atomic_size_t m_running = 0;
+    std::atomic_size_t m_idle = 0;
+    std::atomic_size_t m_overflowWorkers = 0;
+    std::atomic_size_t m_completed = 0;
+    std::atomic_size_t m_stolen = 0;
+    std::atomic<int64_t> m_totalWait = 0;
+    std::atomic<int64_t> m_maxWait = 0;
+    std::atomic<Clock::rep> m_lastStart = 0;
+
+    TaskPool() {
+        m_lastStart = Clock::now().time_since_epoch().count();
+        auto count = std::max<size_t>(std::thread::hardware_concurrency(), 2);
+        for (size_t i = 0; i < count; i++) {
+            m_locals.push_back(std::make_unique<Queue>());
+        }
+        for (size_t i = 0; i < count; i++) {
+            std::thread(&TaskPool::workerLoop, this, i).detach();
+        }
+        std::thread(&TaskPool::monitorLoop, this).detach();
+    }
+
+    std::optional<Job> popFrom(Queue& queue, size_t priority, bool back) {
+        std::unique_lock lock(queue.mutex);
+        auto& jobs = queue.jobs[priority];
+        if (jobs.empty()) {
+            return std::nullopt;
+        }
+        auto job = std::move(back ? jobs.back() : jobs.front());
+        back ? jobs.pop_back() : jobs.pop_front();
+        m_queued -= 1;
+        return job;
+    }
+
+    std::optional<Job> take(size_t self) {
+        if (m_queued == 0) {
+            return std::nullopt;
+        }
+        // Priority always wins over locality
+        for (size_t i = PRIORITY_COUNT; i > 0; i--) {
+            auto const priority = i - 1;
+            // A worker's newest job is the most likely to still be in cache
+            if (self != NOT_A_WORKER) {
+                if (auto job = this->popFrom(*m_locals[self], priority, true)) {
+                    return job;
+                }
+            }
+            if (auto job = this->popFrom(m_global, priority, false)) {
+                return job;
+            }
+            for (size_t offset = 1; offset <= m_locals.size(); offset++) {
+                auto victim = ((self == NOT_A_WORKER ? 0 : self) + offset) % m_locals.size();
+                if (victim == self) continue;
+                if (auto job = this->popFrom(*m_locals[victim], priority, false)) {
+                    m_stolen += 1;
+                    return job;
+                }
+            }
+        }
+        return std::nullopt;
+    }
+
+    void execute(Job& job) {
+        auto now = Clock::now();
+        m_lastStart = now.time_since_epoch().count();
+
+        auto wait = std::chrono::duration_cast<std::chrono::microseconds>(now - job.queuedAt).count();
+        m_totalWait += wait;
+        auto max = m_maxWait.load();
+        while (wait > max && !m_maxWait.compare_exchange_weak(max, wait)) {}
+
+        m_running += 1;
+        job.run();
+        m_running -= 1;
+        m_completed += 1;
+    }
+
+    void workerLoop(size_t index) {
+        s_workerIndex = index;
+        thread::setName(fmt::format("Task Worker {}", index));
+        while (true) {
+            if (auto job = this->take(index)) {
+                this->execute(*job);
+                continue;
+            }
+            std::unique_lock lock(m_sleepMutex);
+            m_idle += 1;
+            m_wake.wait(lock, [this] { return m_queued > 0; });
+            m_idle -= 1;
+        }
+    }
+
+    void overflowLoop() {
+        thread::setName("Task Overflow Worker");
+        while (auto job = this->take(NOT_A_WORKER)) {
+            this->execute(*job);
+        }
+        m_overflowWorkers -= 1;
+    }
+
+    void monitorLoop() {
+        thread::setName("Task Pool Monitor");
+        while (true) {
+            std::this_thread::sleep_for(OVERFLOW_DELAY / 2);
+            if (m_queued == 0 || m_idle > 0) {
+                continue;
+            }
+            auto sinceStart = Clock::now() - Clock::time_point(Clock::duration(m_lastStart.load()));
+            if (sinceStart < OVERFLOW_DELAY) {
+                continue;
+            }
+            // Count this as a start so the next extra thread is only
+            // started if this one gets stuck as well
+            m_lastStart = Clock::now().time_since_epoch().count();
+            m_overflowWorkers += 1;
+            log::debug("All Task workers are busy, starting an extra thread");
+            std::thread(&TaskPool::overflowLoop, this).detach();
+        }
+    }
+
+public:
+    static TaskPool& get() {
+        // Intentionally leaked, since the workers never exit
+        static auto inst = new TaskPool();
+        return *inst;
+    }
+
+    void push(std::function<void()>&& run, TaskPriority priority) {
+        auto& queue = s_workerIndex != NOT_A_WORKER ? *m_locals[s_workerIndex] : m_global;
+        {
+            std::unique_lock lock(queue.mutex);
+            queue.jobs[static_cast<size_t>(priority)].push_back(Job {
+                .run = std::move(run),
+                .queuedAt = Clock::now(),
+            });
+            m_queued += 1;
+        }
+        // Taking the lock pairs with the check in workerLoop, so a worker
+        // that is just about to sleep can't miss the wakeup
+        {
+            std::unique_lock lock(m_sleepMutex);
+        }
+        m_wake.notify_one();
+    }
+
+    TaskPoolStats getStats() const {
+        return TaskPoolStats {
+            .workers = m_locals.size(),
+            .overflowWorkers = m_overflowWorkers,
+            .queued = m_queued,
+            .running = m_running,
+            .completed = m_completed,
+            .stolen = m_stolen,
+            .totalWait = std::chrono::microseconds(m_totalWait.load()),
+            .maxWait = std::chrono::microseconds(m_maxWait.load()),
+        };
+    }
+};
+
+void geode::geode_internal::enqueueTask(std::function<void()> job, TaskPriority priority) {
+    TaskPool::get().push(std::move(job), priority);
+}
+
+TaskPoolStats geode::getTaskPoolStats() {
+    return TaskPool::get().getStats();
+}
@@ -0,0 +1,392 @@
+#include "WebCache.hpp"
+
+#include <Geode/loader/Dirs.hpp>
+#include <Geode/loader/Log.hpp>
+#include <Geode/utils/JsonValidation.hpp>
+#include <Geode/utils/file.hpp>
+#include <Geode/utils/string.hpp>
+#include <date/date.h>
+#include <hash/hash.hpp>
+#include <algorithm>
+#include <atomic>
+#include <sstream>
+
+using namespace geode::prelude;
+using namespace geode::utils::web;
+
+// Cap for how long a response without explicit freshness information is
+// assumed to stay fresh based on its Last-Modified date
+static constexpr int64_t MAX_HEURISTIC_FRESHNESS = 24 * 60 * 60;
+
+static int64_t now() {
+    return std::chrono::duration_cast<std::chrono::seconds>(
+        std::chrono::system_clock::now().time_since_epoch()
+    ).count();
+}
+
+static std::optional<std::string> findHeader(HeaderMap const& headers, std::string_view name) {
+    // HTTP/2 sends header names in lowercase, so they can't be looked up directly
+    for (auto const& [key, values] : headers) {
+        if (!values.empty() && string::caseInsensitiveCompare(key, name) == std::strong_ordering::equal) {
+            return values.front();
+        }
+    }
+    return std::nullopt;
+}
+
+static std::optional<int64_t> parseHTTPDate(std::string const& str) {
+    std::istringstream ss(str);
+    date::sys_seconds seconds;
+    if (ss >> date::parse("%a, %d %b %Y %H:%M:%S GMT", seconds)) {
+        return seconds.time_since_epoch().count();
+    }
+    return std::nullopt;
+}
+
+static matjson::Value headersToJson(HeaderMap const& headers) {
+    auto json = matjson::Value::object();
+    for (auto const& [name, values] : headers) {
+        auto array = matjson::Value::array();
+        for (auto const& value : values) {
+            array.push(value);
+        }
+        json[name] = array;
+    }
+    return json;
+}
+
+static HeaderMap headersFromJson(JsonExpectedValue json) {
+    HeaderMap headers;
+    for (auto& [name, values] : json.properties()) {
+        for (auto& value : values.items()) {
+            headers[name].push_back(value.get<std::string>());
+        }
+    }
+    return headers;
+}
+
+struct CachePolicy {
+    bool noStore = false;
+    bool mustRevalidate = false;
+    int64_t freshFor = 0;
+    int64_t staleFor = 0;
+
+    static CachePolicy from(HeaderMap const& headers) {
+        CachePolicy policy;
+        std::optional<int64_t> maxAge;
+
+        for (auto directive : string::split(findHeader(headers, "Cache-Control").value_or(""), ",")) {
+            string::trimIP(directive);
+            string::toLowerIP(directive);
+            auto eq = directive.find('=');
+            auto name = directive.substr(0, eq);
+            auto value = eq == std::string::npos ? std::nullopt : numFromString<int64_t>(directive.substr(eq + 1)).ok();
+
+            if (name == "no-store") {
+                policy.noStore = true;
+            }
+            else if (name == "no-cache" || name == "must-revalidate") {
+                policy.mustRevalidate = true;
+            }
+            else if (name == "max-age" && value) {
+                maxAge = *value;
+            }
+            else if (name == "stale-while-revalidate" && value) {
+                policy.staleFor = *value;
+            }
+        }
+        if (findHeader(headers, "Vary") == "*") {
+            policy.noStore = true;
+        }
+
+        if (maxAge) {
+            policy.freshFor = *maxAge;
+        }
+        else if (auto expires = findHeader(headers, "Expires")) {
+            // Unparseable dates mean already expired
+            policy.freshFor = parseHTTPDate(*expires).value_or(0) - now();
+        }
+        else if (auto lastModified = findHeader(headers, "Last-Modified")) {
+            // RFC 9111 suggests 10% of the time since the last modification
+            if (auto date = parseHTTPDate(*lastModified)) {
+                policy.freshFor = std::min((now() - *date) / 10, MAX_HEURISTIC_FRESHNESS);
+            }
+        }
+        if (auto age = findHeader(headers, "Age")) {
+            policy.freshFor -= numFromString<int64_t>(*age).unwrapOr(0);
+        }
+        if (policy.mustRevalidate) {
+            policy.freshFor = 0;
+            policy.staleFor = 0;
+        }
+        policy.freshFor = std::max<int64_t>(policy.freshFor, 0);
+        return policy;
+    }
+};
+
+WebCache::WebCache() = default;
+
+WebCache& WebCache::get() {
+    static auto inst = WebCache();
+    return inst;
+}
+
+std::filesystem::path WebCache::getDir() {
+    return dirs::getGeodeDir() / "web-cache";
+}
+
+std::filesystem::path WebCache::getEntryPath(std::string const& keyHash) const {
+    return getDir() / "entries" / (keyHash + ".json");
+}
+std::filesystem::path WebCache::getBodyPath(std::string const& bodyHash) const {
+    return getDir() / "bodies" / bodyHash;
+}
+
+void WebCache::loadIfNeeded() {
+    if (m_loaded) return;
+    m_loaded = true;
+
+    (void)file::createDirectoryAll(getDir() / "entries");
+    (void)file::createDirectoryAll(getDir() / "bodies");
+
+    std::error_code ec;
+    for (auto const& file : std::filesystem::directory_iterator(getDir() / "entries", ec)) {
+        if (file.path().extension() != ".json") continue;
+        auto keyHash = file.path().stem().string();
+
+        auto json = file::readJson(file.path());
+        if (!json) {
+            std::filesystem::remove(file.path(), ec);
+            continue;
+        }
+        Record record;
+        auto root = checkJson(json.unwrap(), "[web cache entry]");
+        root.needs("body").into(record.body);
+        root.needs("size").into(record.size);
+        if (!root.ok() || !std::filesystem::exists(getBodyPath(record.body), ec)) {
+            std::filesystem::remove(file.path(), ec);
+            continue;
+        }
+        // Hits touch the entry file, so its modification time is the last use
+        auto modified = std::filesystem::last_write_time(file.path(), ec);
+        record.lastUsed = ec ? 0 : modified.time_since_epoch().count();
+        this->addRecord(keyHash, std::move(record));
+    }
+
+    // Remove bodies no entry refers to anymore
+    for (auto const& file : std::filesystem::directory_iterator(getDir() / "bodies", ec)) {
+        if (!m_bodyRefs.contains(file.path().filename().string())) {
+            std::filesystem::remove(file.path(), ec);
+        }
+    }
+    this->evict();
+}
+
+void WebCache::addRecord(std::string const& keyHash, Record record) {
+    // Reference the new body before dropping the old record, as both may 
+    // point to the same body
+    if (m_bodyRefs[record.body]++ == 0) {
+        m_totalSize += record.size;
+    }
+    this->removeRecord(keyHash);
+    m_records.insert({ keyHash, std::move(record) });
+}
+
+void WebCache::removeRecord(std::string const& keyHash) {
+    auto it = m_records.find(keyHash);
+    if (it == m_records.end()) return;
+
+    std::error_code ec;
+    if (--m_bodyRefs[it->second.body] == 0) {
+        m_bodyRefs.erase(it->second.body);
+        m_totalSize -= it->second.size;
+        std::filesystem::remove(getBodyPath(it->second.body), ec);
+    }
+    std::filesystem::remove(getEntryPath(keyHash), ec);
+    m_records.erase(it);
+}
+
+void WebCache::evict() {
+    while (m_totalSize > SIZE_LIMIT && !m_records.empty()) {
+        auto oldest = std::min_element(m_records.begin(), m_records.end(), [](auto const& a, auto const& b) {
+            return a.second.lastUsed < b.second.lastUsed;
+        });
+        this->removeRecord(oldest->first);
+    }
+}
+
+Result<> WebCache::writeEntry(
+    std::filesystem::path const& path, std::string const& key, int code,
+    HeaderMap const& headers, std::string const& bodyHash, size_t size
+) {
+    auto policy = CachePolicy::from(headers);
+    auto json = matjson::makeObject({
+        { "url", key },
+        { "code", code },
+        { "headers", headersToJson(headers) },
+        { "body", bodyHash },
+        { "size", size },
+        { "stored-at", now() },
+        { "fresh-for", policy.freshFor },
+        { "stale-for", policy.staleFor },
+        { "must-revalidate", policy.mustRevalidate },
+    });
+    return file::writeString(path, json.dump(matjson::NO_INDENTATION));
+}
+
+std::optional<WebCache::Entry> WebCache::find(std::string const& key, std::chrono::seconds maxStale) {
+    auto keyHash = calculateHash({ reinterpret_cast<uint8_t const*>(key.data()), key.size() });
+
+    // Only the index is guarded by the mutex; the files are read afterwards
+    // so lookups don't wait on each other's disk reads
+    std::string bodyHash;
+    {
+        std::unique_lock lock(m_mutex);
+        this->loadIfNeeded();
+
+        auto record = m_records.find(keyHash);
+        if (record == m_records.end()) {
+            return std::nullopt;
+        }
+        bodyHash = record->second.body;
+        record->second.lastUsed = std::filesystem::file_time_type::clock::now().time_since_epoch().count();
+    }
+    // Drops the record, unless it was replaced while its files were read
+    auto drop = [&] {
+        std::unique_lock lock(m_mutex);
+        auto record = m_records.find(keyHash);
+        if (record != m_records.end() && record->second.body == bodyHash) {
+            this->removeRecord(keyHash);
+        }
+    };
+
+    auto json = file::readJson(getEntryPath(keyHash));
+    auto body = file::readBinary(getBodyPath(bodyHash));
+    if (!json || !body) {
+        drop();
+        return std::nullopt;
+    }
+
+    Entry entry;
+    int64_t storedAt = 0, freshFor = 0, staleFor = 0;
+    bool mustRevalidate = false;
+    auto root = checkJson(json.unwrap(), "[web cache entry]");
+    root.needs("code").into(entry.code);
+    entry.headers = headersFromJson(root.needs("headers"));
+    root.needs("stored-at").into(storedAt);
+    root.needs("fresh-for").into(freshFor);
+    root.needs("stale-for").into(staleFor);
+    root.needs("must-revalidate").into(mustRevalidate);
+    if (!root.ok()) {
+        log::warn("Dropping invalid web cache entry for {}: {}", key, root.ok().unwrapErr());
+        drop();
+        return std::nullopt;
+    }
+    entry.body = std::move(body).unwrap();
+    entry.bodyHash = bodyHash;
+    entry.etag = findHeader(entry.headers, "ETag");
+    entry.lastModified = findHeader(entry.headers, "Last-Modified");
+
+    auto age = now() - storedAt;
+    entry.fresh = age < freshFor;
+    entry.usableWhileRevalidating = !mustRevalidate && age < freshFor + std::max(staleFor, maxStale.count());
+
+    std::error_code ec;
+    std::filesystem::last_write_time(getEntryPath(keyHash), std::filesystem::file_time_type::clock::now(), ec);
+
+    return entry;
+}
+
+void WebCache::store(std::string const& key, int code, HeaderMap const& headers, ByteVector const& body) {
+    auto keyHash = calculateHash({ reinterpret_cast<uint8_t const*>(key.data()), key.size() });
+    // A single response taking up most of the cache would just evict everything else
+    bool storable = !CachePolicy::from(headers).noStore && body.size() <= SIZE_LIMIT / 8;
+    auto bodyHash = storable ? calculateHash(body) : std::string();
+
+    std::unique_lock lock(m_mutex);
+    this->loadIfNeeded();
+
+    if (!storable) {
+        this->removeRecord(keyHash);
+        return;
+    }
+
+    std::error_code ec;
+    if (!std::filesystem::exists(getBodyPath(bodyHash), ec)) {
+        if (auto res = file::writeBinary(getBodyPath(bodyHash), body); !res) {
+            log::warn("Unable to write web cache body for {}: {}", key, res.unwrapErr());
+            return;
+        }
+    }
+    this->addRecord(keyHash, Record {
+        .body = bodyHash,
+        .size = body.size(),
+        .lastUsed = std::filesystem::file_time_type::clock::now().time_since_epoch().count(),
+    });
+    if (auto res = this->writeEntry(getEntryPath(keyHash), key, code, headers, bodyHash, body.size()); !res) {
+        log::warn("Unable to write web cache entry for {}: {}", key, res.unwrapErr());
+        this->removeRecord(keyHash);
+        return;
+    }
+    this->evict();
+}
+
+void WebCache::refresh(std::string const& key, Entry const& cached, HeaderMap const& headers) {
+    static std::atomic_size_t tempCounter = 0;
+
+    auto keyHash = calculateHash({ reinterpret_cast<uint8_t const*>(key.data()), key.size() });
+
+    // The 304 carries the updated validators and freshness information
+    auto merged = cached.headers;
+    for (auto const& [name, values] : headers) {
+        std::erase_if(merged, [&](auto const& pair) {
+            return string::caseInsensitiveCompare(pair.first, name) == std::strong_ordering::equal;
+        });
+        merged.insert({ name, values });
+    }
+    bool storable = !CachePolicy::from(merged).noStore;
+
+    // The entry is written to a temporary file without holding the mutex, and
+    // only moved into place if the record wasn't replaced in the meantime
+    auto tempPath = getEntryPath(keyHash);
+    tempPath += fmt::format(".{}.tmp", tempCounter++);
+    if (storable) {
+        auto res = this->writeEntry(tempPath, key, cached.code, merged, cached.bodyHash, cached.body.size());
+        if (!res) {
+            log::warn("Unable to write web cache entry for {}: {}", key, res.unwrapErr());
+            storable = false;
+        }
+    }
+
+    std::error_code ec;
+    std::unique_lock lock(m_mutex);
+    this->loadIfNeeded();
+
+    auto record = m_records.find(keyHash);
+    if (record == m_records.end() || record->second.body != cached.bodyHash) {
+        std::filesystem::remove(tempPath, ec);
+        return;
+    }
+    if (!storable) {
+        std::filesystem::remove(tempPath, ec);
+        this->removeRecord(keyHash);
+        return;
+    }
+    std::filesystem::rename(tempPath, getEntryPath(keyHash), ec);
+    if (ec) {
+        log::warn("Unable to write web cache entry for {}: {}", key, ec.message());
+        std::filesystem::remove(tempPath, ec);
+        return;
+    }
+    record->second.lastUsed = std::filesystem::file_time_type::clock::now().time_since_epoch().count();
+}
+
+void WebCache::clear() {
+    std::unique_lock lock(m_mutex);
+    m_records.clear();
+    m_bodyRefs.clear();
+    m_totalSize = 0;
+    m_loaded = false;
+    std::error_code ec;
+    std::filesystem::remove_all(getDir(), ec);
+}
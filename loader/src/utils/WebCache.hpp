@@ -0,0 +1,95 @@
+#pragma once
+
+#include <Geode/Result.hpp>
+#include <Geode/utils/general.hpp>
+#include <chrono>
+#include <filesystem>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace geode::utils::web {
+    using HeaderMap = std::unordered_map<std::string, std::vector<std::string>>;
+
+    /**
+     * On-disk HTTP cache for WebRequests that opt into caching. Entries are
+     * kept as small header files keyed by the hash of the request URL, while
+     * bodies are stored by the hash of their contents so identical responses
+     * share a file. Once the bodies exceed the size limit, the least recently
+     * used entries are evicted
+     */
+    class WebCache final {
+    public:
+        struct Entry {
+            int code = 0;
+            HeaderMap headers;
+            ByteVector body;
+            std::string bodyHash;
+            std::optional<std::string> etag;
+            std::optional<std::string> lastModified;
+            // Can be used as-is without contacting the server
+            bool fresh = false;
+            // Can be used right away while being revalidated in the background
+            bool usableWhileRevalidating = false;
+        };
+
+    private:
+        struct Record {
+            std::string body;
+            size_t size = 0;
+            int64_t lastUsed = 0;
+        };
+
+        std::mutex m_mutex;
+        bool m_loaded = false;
+        std::unordered_map<std::string, Record> m_records;
+        std::unordered_map<std::string, size_t> m_bodyRefs;
+        size_t m_totalSize = 0;
+
+        WebCache();
+
+        std::filesystem::path getEntryPath(std::string const& keyHash) const;
+        std::filesystem::path getBodyPath(std::string const& bodyHash) const;
+        void loadIfNeeded();
+        void addRecord(std::string const& keyHash, Record record);
+        void removeRecord(std::string const& keyHash);
+        void evict();
+        Result<> writeEntry(std::filesystem::path const& path, std::string const& key, int code, HeaderMap const& headers, std::string const& bodyHash, size_t size);
+
+    public:
+        // Budget for the stored bodies
+        static constexpr size_t SIZE_LIMIT = 64 * 1024 * 1024;
+
+        static WebCache& get();
+
+        static std::filesystem::path getDir();
+
+        /**
+         * Look up the cached response for a request
+         * @param key The full URL of the request
+         * @param maxStale How long past its freshness the caller is willing
+         * to use the entry while it's revalidated, on top of any
+         * stale-while-revalidate the server allowed
+         */
+        std::optional<Entry> find(std::string const& key, std::chrono::seconds maxStale);
+        /**
+         * Store a response, unless its headers forbid it. Does file I/O, so
+         * should be called off the Web Engine thread
+         */
+        void store(std::string const& key, int code, HeaderMap const& headers, ByteVector const& body);
+        /**
+         * Renew the headers of a cached response after the server answered a
+         * conditional request with 304 Not Modified. Does file I/O, so should
+         * be called off the Web Engine thread
+         * @param cached The entry find returned for the request
+         * @param headers The headers of the 304 response
+         */
+        void refresh(std::string const& key, Entry const& cached, HeaderMap const& headers);
+        /**
+         * Remove every cached response from disk
+         */
+        void clear();
+    };
+}
@@ -1,6 +1,7 @@
 #include <Geode/loader/Loader.hpp> // a third great circular dependency fix
 #include <Geode/loader/Log.hpp>
 #include <Geode/utils/file.hpp>
+#include <Geode/utils/JsonValidation.hpp>
 #include <Geode/utils/map.hpp>
 #include <Geode/utils/string.hpp>
 #include <matjson.hpp>
@@ -164,6 +165,7 @@ struct ZipEntry {
     bool isDirectory;
     int64_t compressedSize;
     int64_t uncompressedSize;
+    uint32_t crc32;
 };
 
 class Zip::Impl final {
@@ -250,6 +252,7 @@ private:
                 .isDirectory = mz_zip_entry_is_dir(m_handle) == MZ_OK,
                 .compressedSize = info->compressed_size,
                 .uncompressedSize = info->uncompressed_size,
+                .crc32 = info->crc,
             } });
 
             err = mz_zip_goto_next_entry(m_handle);
@@ -320,10 +323,21 @@ public:
 
         mz_zip_entry_close(m_handle);
 
-        GEODE_UNWRAP(file::createDirectoryAll((dir / name).parent_path()));
-        GEODE_UNWRAP(file::writeBinary(dir / name, res).mapErr([&](auto error) {
-            return fmt::format("Unable to write to {}: {}", dir / name, error);
+        // write next to the target and move it into place, so an interrupted
+        // extraction never leaves a truncated file behind
+        auto target = dir / name;
+        auto partial = target;
+        partial += ".partial";
+        GEODE_UNWRAP(file::createDirectoryAll(target.parent_path()));
+        GEODE_UNWRAP(file::writeBinary(partial, res).mapErr([&](auto error) {
+            return fmt::format("Unable to write to {}: {}", target, error);
         }));
+        std::error_code ec;
+        std::filesystem::rename(partial, target, ec);
+        if (ec) {
+            std::filesystem::remove(partial, ec);
+            return Err(fmt::format("Unable to write to {}: {}", target, ec.message()));
+        }
 
         return Ok();
     }
@@ -387,6 +401,124 @@ public:
         return Ok();
     }
 
+    Result<> extractAllToIncremental(Path const& dir, Path const& manifestPath) {
+        // CRC-32 and size of every file written by the previous extraction
+        std::unordered_map<std::string, std::pair<int64_t, int64_t>> previous;
+        if (std::filesystem::exists(manifestPath)) {
+            if (auto json = file::readJson(manifestPath)) {
+                auto root = checkJson(json.unwrap(), "[manifest]");
+                for (auto& [name, value] : root.properties()) {
+                    std::pair<int64_t, int64_t> stamp;
+                    value.needs("crc32").into(stamp.first);
+                    value.needs("size").into(stamp.second);
+                    previous.insert({ name, stamp });
+                }
+                if (!root) {
+                    previous.clear();
+                }
+            }
+        }
+
+        // the manifest is only written back once everything has been
+        // extracted, so if this gets interrupted no entry is trusted next time
+        std::error_code ec;
+        std::filesystem::remove(manifestPath, ec);
+
+        GEODE_UNWRAP(file::createDirectoryAll(dir));
+
+        GEODE_UNWRAP(
+            mzTry(mz_zip_goto_first_entry(m_handle))
+            .mapErr([&](auto error) {
+                return fmt::format("Unable to navigate to first entry (code {})", error);
+            })
+        );
+
+        uint64_t numEntries;
+
+        GEODE_UNWRAP(
+            mzTry(mz_zip_get_number_entry(m_handle, &numEntries))
+            .mapErr([&](auto error) {
+                return fmt::format("Unable to get number of entries (code {})", error);
+            })
+        );
+
+        auto manifest = matjson::Value::object();
+        uint32_t currentEntry = 0;
+        uint32_t writtenEntries = 0;
+        do {
+            mz_zip_file* info = nullptr;
+            if (mz_zip_entry_get_info(m_handle, &info) != MZ_OK) {
+                return Err("Unable to get entry info");
+            }
+            currentEntry++;
+
+            std::string name(info->filename, info->filename + info->filename_size);
+            Path filePath;
+            filePath.assign(name.begin(), name.end());
+
+            // make sure zip files like root/../../file.txt don't get extracted to 
+            // avoid zip attacks
+#ifdef GEODE_IS_WINDOWS
+            if (std::filesystem::relative((dir / filePath).wstring(), dir.wstring()).empty()) {
+#else
+            if (std::filesystem::relative(dir / filePath, dir).empty()) {
+#endif
+                log::error(
+                    "Zip entry '{}' is not contained within zip bounds",
+                    dir / filePath
+                );
+                continue;
+            }
+
+            auto const& entry = m_entries.at(filePath);
+            if (entry.isDirectory) {
+                GEODE_UNWRAP(file::createDirectoryAll(dir / filePath));
+            }
+            else {
+                std::pair<int64_t, int64_t> stamp { entry.crc32, entry.uncompressedSize };
+                auto prev = previous.find(name);
+                auto unchanged = prev != previous.end() && prev->second == stamp &&
+                    std::filesystem::file_size(dir / filePath, ec) == static_cast<uintmax_t>(stamp.second) && !ec;
+                if (!unchanged) {
+                    GEODE_UNWRAP(this->extractAt(dir, filePath));
+                    writtenEntries++;
+                }
+                if (prev != previous.end()) {
+                    previous.erase(prev);
+                }
+                manifest[name] = matjson::makeObject({
+                    { "crc32", stamp.first },
+                    { "size", stamp.second },
+                });
+            }
+            if (m_progressCallback) {
+                m_progressCallback(currentEntry, numEntries);
+            }
+        } while (mz_zip_goto_next_entry(m_handle) == MZ_OK);
+
+        // anything left over was removed from the zip since last time
+        for (auto const& [name, _] : previous) {
+            Path filePath;
+            filePath.assign(name.begin(), name.end());
+            std::filesystem::remove(dir / filePath, ec);
+        }
+
+        log::debug(
+            "Wrote {} of {} entries, removed {}",
+            writtenEntries, currentEntry, previous.size()
+        );
+
+        auto partialManifest = manifestPath;
+        partialManifest += ".partial";
+        GEODE_UNWRAP(file::writeString(partialManifest, manifest.dump(matjson::NO_INDENTATION)));
+        std::filesystem::rename(partialManifest, manifestPath, ec);
+        if (ec) {
+            return Err(fmt::format("Unable to write manifest: {}", ec.message()));
+        }
+
+        return Ok();
+    }
+
     Result<ByteVector> extract(Path const& name) {
         if (!m_entries.count(name)) {
             return Err("Entry not found");
@@ -588,6 +720,10 @@ Result<> Unzip::extractAllTo(Path const& dir) {
     return m_impl->extractAllTo(dir);
 }
 
+Result<> Unzip::extractAllToIncremental(Path const& dir, Path const& manifest) {
+    return m_impl->extractAllToIncremental(dir, manifest);
+}
+
 Result<> Unzip::intoDir(
     Path const& from,
     Path const& to,
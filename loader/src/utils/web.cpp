@@ -4,10 +4,15 @@
 #include <fmt/core.h>
 #include <fstream>
 #include <matjson.hpp>
+#include <mutex>
 #include <system_error>
+#include <thread>
+#include <unordered_map>
 #define CURL_STATICLIB
 #include <curl/curl.h>
 #include <ca_bundle.h>
+#include <hash/hash.hpp>
+#include "WebCache.hpp"
 
 #include <Geode/utils/web.hpp>
 #include <Geode/utils/map.hpp>
@@ -97,6 +102,9 @@ public:
     int m_code;
     ByteVector m_data;
     std::unordered_map<std::string, std::vector<std::string>> m_headers;
+    // Set if the body was streamed into a file instead of m_data
+    std::optional<std::filesystem::path> m_downloadPath;
+    std::optional<std::string> m_sha256;
 
     Result<> into(std::filesystem::path const& path) const;
 };
@@ -109,6 +117,14 @@ Result<> WebResponse::Impl::into(std::filesystem::path const& path) const {
         return Err(fmt::format("Couldn't write to file: {}", ec.category().message(ec.value())));
     }
 
+    if (m_downloadPath) {
+        std::filesystem::copy_file(*m_downloadPath, path, std::filesystem::copy_options::overwrite_existing, ec);
+        if (ec) {
+            return Err(fmt::format("Couldn't write to file: {}", ec.category().message(ec.value())));
+        }
+        return Ok();
+    }
+
     auto stream = std::ofstream(path, std::ios::out | std::ios::binary);
     stream.write(reinterpret_cast<const char*>(m_data.data()), m_data.size());
     stream.close();
@@ -140,6 +156,9 @@ ByteVector WebResponse::data() const {
 Result<> WebResponse::into(std::filesystem::path const& path) const {
     return m_impl->into(path);
 }
+std::optional<std::string> WebResponse::sha256() const {
+    return m_impl->m_sha256;
+}
 
 std::vector<std::string> WebResponse::headers() const {
     return map::keys(m_impl->m_headers);
@@ -202,6 +221,9 @@ public:
     std::optional<ByteVector> m_body;
     std::optional<std::chrono::seconds> m_timeout;
     std::optional<std::pair<std::uint64_t, std::uint64_t>> m_range;
+    std::optional<std::filesystem::path> m_downloadPath;
+    bool m_cache = false;
+    std::chrono::seconds m_staleWhileRevalidate = std::chrono::seconds(0);
     bool m_certVerification = true;
     bool m_transferBody = true;
     bool m_followRedirects = true;
@@ -219,6 +241,13 @@ public:
         res.m_impl->m_data = ByteVector(msg.begin(), msg.end());
         return res;
     }
+    WebResponse makeCachedResponse(WebCache::Entry const& entry) {
+        auto res = WebResponse();
+        res.m_impl->m_code = entry.code;
+        res.m_impl->m_data = entry.body;
+        res.m_impl->m_headers = entry.headers;
+        return res;
+    }
 };
 
 std::atomic_size_t WebRequest::Impl::s_idCounter = 0;
@@ -240,42 +269,215 @@ static std::string urlParamEncode(std::string_view input) {
     return ss.str();
 }
 
+// Runs every WebRequest on a single background thread through curl's multi 
+// interface, so connections, TLS sessions and DNS lookups are reused across 
+// requests instead of being thrown away after each one
+class WebEngine final {
+public:
+    // Called on the engine thread once a transfer ends; owns the easy handle
+    using OnDone = std::function<void(CURLcode)>;
+
+private:
+    CURLM* m_multi;
+    CURLSH* m_share;
+    std::mutex m_mutex;
+    std::vector<std::pair<CURL*, OnDone>> m_queued;
+    std::optional<long> m_maxHostConnections = DEFAULT_MAX_HOST_CONNECTIONS;
+    // Only touched from the engine thread
+    std::unordered_map<CURL*, OnDone> m_running;
+
+    WebEngine() : m_multi(curl_multi_init()), m_share(curl_share_init()) {
+        // The multi handle already shares its connection pool between its 
+        // transfers; the share handle adds resolved hosts and TLS sessions
+        curl_share_setopt(m_share, CURLSHOPT_SHARE, CURL_LOCK_DATA_DNS);
+        curl_share_setopt(m_share, CURLSHOPT_SHARE, CURL_LOCK_DATA_SSL_SESSION);
+        std::thread(&WebEngine::run, this).detach();
+    }
+
+    void run() {
+        thread::setName("Web Engine");
+        while (true) {
+            {
+                std::unique_lock lock(m_mutex);
+                if (m_maxHostConnections) {
+                    curl_multi_setopt(m_multi, CURLMOPT_MAX_HOST_CONNECTIONS, *m_maxHostConnections);
+                    m_maxHostConnections = std::nullopt;
+                }
+                for (auto& [curl, onDone] : m_queued) {
+                    // The share handle has no locks, so it may only be 
+                    // attached from this thread
+                    curl_easy_setopt(curl, CURLOPT_SHARE, m_share);
+                    curl_multi_add_handle(m_multi, curl);
+                    m_running.insert({ curl, std::move(onDone) });
+                }
+                m_queued.clear();
+            }
+
+            int running = 0;
+            curl_multi_perform(m_multi, &running);
+
+            int left = 0;
+            while (auto msg = curl_multi_info_read(m_multi, &left)) {
+                if (msg->msg != CURLMSG_DONE) continue;
+                // The message is freed when the handle is removed
+                auto curl = msg->easy_handle;
+                auto result = msg->data.result;
+                curl_multi_remove_handle(m_multi, curl);
+                if (auto node = m_running.extract(curl)) {
+                    node.mapped()(result);
+                }
+            }
+
+            // Sleeps until there's socket activity, a curl timeout or a new 
+            // transfer is added
+            curl_multi_poll(m_multi, nullptr, 0, 1000, nullptr);
+        }
+    }
+
+public:
+    // Same as the limit most browsers use
+    static constexpr long DEFAULT_MAX_HOST_CONNECTIONS = 6;
+
+    static WebEngine& get() {
+        // Intentionally leaked, as the engine thread runs until the game exits
+        static auto inst = new WebEngine();
+        return *inst;
+    }
+
+    void add(CURL* curl, OnDone onDone) {
+        std::unique_lock lock(m_mutex);
+        m_queued.emplace_back(curl, std::move(onDone));
+        curl_multi_wakeup(m_multi);
+    }
+
+    void setMaxHostConnections(size_t count) {
+        std::unique_lock lock(m_mutex);
+        m_maxHostConnections = static_cast<long>(count);
+        curl_multi_wakeup(m_multi);
+    }
+};
+
+void web::setMaxConnectionsPerHost(size_t count) {
+    WebEngine::get().setMaxHostConnections(count);
+}
+
 WebTask WebRequest::send(std::string_view method, std::string_view url) {
     m_impl->m_method = method;
     m_impl->m_url = url;
-    return WebTask::run([impl = m_impl](auto progress, auto hasBeenCancelled) -> WebTask::Result {
+    return WebTask::runWithCallback([impl = m_impl](auto finish, auto progress, auto hasBeenCancelled) {
+        // Add parameters to the URL
+        auto url = impl->m_url;
+        bool first = url.find('?') == std::string::npos;
+        for (auto& [key, value] : impl->m_urlParameters) {
+            url += (first ? "?" : "&") + urlParamEncode(key) + "=" + urlParamEncode(value);
+            first = false;
+        }
+
+        // Requests that opt into caching may be answered straight from disk; 
+        // otherwise the cached validators are sent along so an unchanged 
+        // body isn't transferred again
+        std::optional<std::string> cacheKey;
+        std::optional<WebCache::Entry> cached;
+        bool revalidateInBackground = false;
+        if (impl->m_cache && impl->m_method == "GET" && impl->m_transferBody && !impl->m_range && !impl->m_downloadPath) {
+            cacheKey = url;
+            cached = WebCache::get().find(url, impl->m_staleWhileRevalidate);
+            if (cached && cached->fresh) {
+                return finish(impl->makeCachedResponse(*cached));
+            }
+            if (cached && cached->usableWhileRevalidating) {
+                finish(impl->makeCachedResponse(*cached));
+                revalidateInBackground = true;
+            }
+        }
+
         // Init Curl
         auto curl = curl_easy_init();
         if (!curl) {
-            return impl->makeError(-1, "Curl not initialized");
+            return finish(impl->makeError(-1, "Curl not initialized"));
         }
 
-        // todo: in the future, we might want to support downloading directly into 
-        // files / in-memory streams like the old AsyncWebRequest class
+        // Successful downloads to a file are first written next to the 
+        // target and only moved into place once the transfer is complete
+        std::optional<std::filesystem::path> tempPath;
+        if (impl->m_downloadPath) {
+            tempPath = *impl->m_downloadPath;
+            *tempPath += ".partial";
+        }
 
-        // Struct that holds values for the curl callbacks
+        // Struct that holds values for the curl callbacks; lives until the 
+        // engine reports the transfer as done
         struct ResponseData {
             WebResponse response;
-            Impl* impl;
+            std::shared_ptr<Impl> impl;
+            CURL* curl;
+            curl_slist* headers = nullptr;
+            WebTask::PostResult finish;
             WebTask::PostProgress progress;
             WebTask::HasBeenCancelled hasBeenCancelled;
-        } responseData = {
+            std::optional<std::filesystem::path> tempPath;
+            bool receivedData = false;
+            std::ofstream file;
+            std::optional<HashCalculator> hash;
+            std::optional<std::string> fileError;
+            std::optional<std::string> cacheKey;
+            std::optional<WebCache::Entry> cached;
+            // The task was already finished from the cache, so this transfer 
+            // only updates the cache and can't be cancelled
+            bool revalidateInBackground = false;
+        };
+        auto responseData = std::make_shared<ResponseData>(ResponseData {
             .response = WebResponse(),
-            .impl = impl.get(),
+            .impl = impl,
+            .curl = curl,
+            .finish = finish,
             .progress = progress,
             .hasBeenCancelled = hasBeenCancelled,
-        };
+            .tempPath = tempPath,
+            .cacheKey = cacheKey,
+            .cached = std::move(cached),
+            .revalidateInBackground = revalidateInBackground,
+        });
+
+        // Store downloaded response data into a byte vector, or stream it 
+        // into the target file if this is a successful download to a file
+        curl_easy_setopt(curl, CURLOPT_WRITEDATA, responseData.get());
+        curl_easy_setopt(curl, CURLOPT_WRITEFUNCTION, +[](char* data, size_t size, size_t nmemb, void* ptr) -> size_t {
+            auto response = static_cast<ResponseData*>(ptr);
+
+            // The response code is known by the time the body starts arriving; 
+            // error bodies are kept in memory so they can still be read as text
+            if (!response->receivedData) {
+                response->receivedData = true;
+                long code = 0;
+                curl_easy_getinfo(response->curl, CURLINFO_RESPONSE_CODE, &code);
+                if (response->tempPath && 200 <= code && code < 300) {
+                    response->file.open(*response->tempPath, std::ios::out | std::ios::binary | std::ios::trunc);
+                    if (!response->file) {
+                        response->fileError = "Couldn't open file for writing";
+                        return 0;
+                    }
+                    response->hash.emplace();
+                }
+            }
 
-        // Store downloaded response data into a byte vector
-        curl_easy_setopt(curl, CURLOPT_WRITEDATA, &responseData);
-        curl_easy_setopt(curl, CURLOPT_WRITEFUNCTION, +[](char* data, size_t size, size_t nmemb, void* ptr) {
-            auto& target = static_cast<ResponseData*>(ptr)->response.m_impl->m_data;
+            if (response->hash) {
+                response->file.write(data, size * nmemb);
+                if (!response->file) {
+                    response->fileError = "Couldn't write to file";
+                    return 0;
+                }
+                response->hash->update({ reinterpret_cast<uint8_t const*>(data), size * nmemb });
+                return size * nmemb;
+            }
+
+            auto& target = response->response.m_impl->m_data;
             target.insert(target.end(), data, data + size * nmemb);
             return size * nmemb;
         });
 
         // Set headers
-        curl_slist* headers = nullptr;
+        auto& headers = responseData->headers;
         for (auto& [name, values] : impl->m_headers) {
             // Sanitize header name
             auto header = name;
@@ -288,15 +490,17 @@ WebTask WebRequest::send(std::string_view method, std::string_view url) {
                 headers = curl_slist_append(headers, header.c_str());
             }
         }
+        if (auto const& entry = responseData->cached) {
+            if (entry->etag) {
+                headers = curl_slist_append(headers, ("If-None-Match: " + *entry->etag).c_str());
+            }
+            if (entry->lastModified) {
+                headers = curl_slist_append(headers, ("If-Modified-Since: " + *entry->lastModified).c_str());
+            }
+        }
         curl_easy_setopt(curl, CURLOPT_HTTPHEADER, headers);
 
-        // Add parameters to the URL and pass it to curl
-        auto url = impl->m_url;
-        bool first = url.find('?') == std::string::npos;
-        for (auto& [key, value] : impl->m_urlParameters) {
-            url += (first ? "?" : "&") + urlParamEncode(key) + "=" + urlParamEncode(value);
-            first = false;
-        }
+        // Pass the URL to curl
         curl_easy_setopt(curl, CURLOPT_URL, url.c_str());
 
         // Set HTTP version
@@ -330,13 +534,18 @@ WebTask WebRequest::send(std::string_view method, std::string_view url) {
         if (impl->m_certVerification) {
             curl_blob caBundleBlob = {};
 
+            // The built-in bundle is static and custom ones are kept alive by 
+            // the request, so neither needs to be copied for every transfer
             if (impl->m_CABundleContent.empty()) {
-                impl->m_CABundleContent = CA_BUNDLE_CONTENT;
+                static std::string_view const defaultBundle = CA_BUNDLE_CONTENT;
+                caBundleBlob.data = const_cast<char*>(defaultBundle.data());
+                caBundleBlob.len = defaultBundle.size();
             }
-            
-            caBundleBlob.data = reinterpret_cast<void*>(impl->m_CABundleContent.data());
-            caBundleBlob.len = impl->m_CABundleContent.size();
-            caBundleBlob.flags = CURL_BLOB_COPY;
+            else {
+                caBundleBlob.data = impl->m_CABundleContent.data();
+                caBundleBlob.len = impl->m_CABundleContent.size();
+            }
+            caBundleBlob.flags = CURL_BLOB_NOCOPY;
             curl_easy_setopt(curl, CURLOPT_CAINFO_BLOB, &caBundleBlob);
         }
 
@@ -401,7 +610,7 @@ WebTask WebRequest::send(std::string_view method, std::string_view url) {
         curl_easy_setopt(curl, CURLOPT_FAILONERROR, 0L);
 
         // Get headers from the response
-        curl_easy_setopt(curl, CURLOPT_HEADERDATA, &responseData);
+        curl_easy_setopt(curl, CURLOPT_HEADERDATA, responseData.get());
         curl_easy_setopt(curl, CURLOPT_HEADERFUNCTION, (+[](char* buffer, size_t size, size_t nitems, void* ptr) {
             auto& headers = static_cast<ResponseData*>(ptr)->response.m_impl->m_headers;
             std::string line;
@@ -425,10 +634,15 @@ WebTask WebRequest::send(std::string_view method, std::string_view url) {
         }));
 
         // Track & post progress on the Promise
-        curl_easy_setopt(curl, CURLOPT_PROGRESSDATA, &responseData);
+        curl_easy_setopt(curl, CURLOPT_PROGRESSDATA, responseData.get());
         curl_easy_setopt(curl, CURLOPT_PROGRESSFUNCTION, +[](void* ptr, double dtotal, double dnow, double utotal, double unow) -> int {
             auto data = static_cast<ResponseData*>(ptr);
 
+            // Nobody is listening for the progress of a background revalidation
+            if (data->revalidateInBackground) {
+                return 0;
+            }
+
             // Check for cancellation and abort if so
             if (data->hasBeenCancelled()) {
                 return 1;
@@ -446,36 +660,100 @@ WebTask WebRequest::send(std::string_view method, std::string_view url) {
             return 0;
         });
 
-        // Make the actual web request
-        auto curlResponse = curl_easy_perform(curl);
+        // Hand the transfer over to the engine, which finishes the task 
+        // from its own thread
+        WebEngine::get().add(curl, [responseData](CURLcode curlResponse) {
+            auto& data = *responseData;
+            auto curl = data.curl;
+            auto const& impl = data.impl;
+
+            // Get the response code; note that this will be invalid if the 
+            // curlResponse is not CURLE_OK
+            long code = 0;
+            curl_easy_getinfo(curl, CURLINFO_RESPONSE_CODE, &code);
+            data.response.m_impl->m_code = static_cast<int>(code);
+
+            // Free up curl memory
+            curl_slist_free_all(data.headers);
+            curl_easy_cleanup(curl);
+
+            // Finish the download to a file; the partial file is removed on any 
+            // failure so a broken download never ends up at the target path
+            if (data.tempPath) {
+                data.file.close();
+                if (curlResponse == CURLE_OK && !data.fileError && 200 <= code && code < 300) {
+                    // Empty bodies never call the write callback
+                    if (!data.hash) {
+                        data.file.open(*data.tempPath, std::ios::out | std::ios::binary | std::ios::trunc);
+                        data.file.close();
+                        data.hash.emplace();
+                    }
+                    std::error_code ec;
+                    std::filesystem::rename(*data.tempPath, *impl->m_downloadPath, ec);
+                    if (ec) {
+                        data.fileError = fmt::format("Couldn't move downloaded file: {}", ec.message());
+                    }
+                    else {
+                        data.response.m_impl->m_downloadPath = impl->m_downloadPath;
+                        data.response.m_impl->m_sha256 = data.hash->finish();
+                    }
+                }
+                if (!data.response.m_impl->m_downloadPath) {
+                    std::error_code ec;
+                    std::filesystem::remove(*data.tempPath, ec);
+                }
+            }
 
-        // Get the response code; note that this will be invalid if the 
-        // curlResponse is not CURLE_OK
-        long code = 0;
-        curl_easy_getinfo(curl, CURLINFO_RESPONSE_CODE, &code);
-        responseData.response.m_impl->m_code = static_cast<int>(code);
+            // Update the cache with the new response, or reuse the cached body 
+            // if the server says it hasn't changed. The cache is written on the 
+            // task pool, as this thread is shared by every request
+            if (data.cacheKey && curlResponse == CURLE_OK) {
+                if (code == 304 && data.cached) {
+                    auto headers = std::move(data.response.m_impl->m_headers);
+                    data.response = impl->makeCachedResponse(*data.cached);
+                    geode_internal::enqueueTask([
+                        key = *data.cacheKey, cached = std::move(*data.cached),
+                        headers = std::move(headers)
+                    ] {
+                        WebCache::get().refresh(key, cached, headers);
+                    }, TaskPriority::Background);
+                }
+                else if (code == 200) {
+                    geode_internal::enqueueTask([
+                        key = *data.cacheKey, headers = data.response.m_impl->m_headers,
+                        body = data.response.m_impl->m_data
+                    ] {
+                        WebCache::get().store(key, 200, headers, body);
+                    }, TaskPriority::Background);
+                }
+            }
+            if (data.revalidateInBackground) {
+                return;
+            }
 
-        // Free up curl memory
-        curl_slist_free_all(headers);
-        curl_easy_cleanup(curl);
+            // Fall back to a cached response if the server can't be reached
+            if (curlResponse != CURLE_OK && data.cached && !data.hasBeenCancelled()) {
+                log::debug("Using cached response for {} as the request failed: {}", *data.cacheKey, curl_easy_strerror(curlResponse));
+                return data.finish(impl->makeCachedResponse(*data.cached));
+            }
 
-        // Check if the request failed on curl's side or because of cancellation
-        if (curlResponse != CURLE_OK) {
-            if (hasBeenCancelled()) {
-                return WebTask::Cancel();
+            // Check if the request failed on curl's side or because of cancellation
+            if (data.fileError && !data.hasBeenCancelled()) {
+                return data.finish(impl->makeError(-1, *data.fileError));
             }
-            else {
-                return impl->makeError(-1, "Curl failed: " + std::string(curl_easy_strerror(curlResponse)));
+            if (curlResponse != CURLE_OK) {
+                if (data.hasBeenCancelled()) {
+                    return data.finish(WebTask::Cancel());
+                }
+                else {
+                    return data.finish(impl->makeError(-1, "Curl failed: " + std::string(curl_easy_strerror(curlResponse))));
+                }
             }
-        }
-        
-        // Check if the response was an error code
-        if (code >= 400 && code <= 600) {
-            return std::move(responseData.response);
-        }
 
-        // Otherwise resolve with success :-)
-        return std::move(responseData.response);
+            // Otherwise resolve with the response; error codes are handled 
+            // by the caller through WebResponse::ok()
+            data.finish(std::move(data.response));
+        });
     }, fmt::format("{} request to {}", method, url));
 }
 WebTask WebRequest::post(std::string_view url) {
@@ -558,6 +836,22 @@ WebRequest& WebRequest::timeout(std::chrono::seconds time) {
     return *this;
 }
 
+WebRequest& WebRequest::cache(bool enabled) {
+    m_impl->m_cache = enabled;
+    return *this;
+}
+
+WebRequest& WebRequest::staleWhileRevalidate(std::chrono::seconds maxStale) {
+    m_impl->m_cache = true;
+    m_impl->m_staleWhileRevalidate = maxStale;
+    return *this;
+}
+
+WebRequest& WebRequest::downloadTo(std::filesystem::path const& path) {
+    m_impl->m_downloadPath = path;
+    return *this;
+}
+
 WebRequest& WebRequest::downloadRange(std::pair<std::uint64_t, std::uint64_t> byteRange) {
     m_impl->m_range = byteRange;
     return *this;
@@ -647,4 +941,4 @@ std::optional<std::chrono::seconds> WebRequest::getTimeout() const {
 
 HttpVersion WebRequest::getHttpVersion() const {
     return m_impl->m_httpVersion;
-}
\ No newline at end of file
+}
\ No newline at end of file
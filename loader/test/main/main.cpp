@@ -25,6 +25,460 @@ $execute {
     });
 }
 
+// Event dispatch benchmark, run with --geode:bench-events
+struct BenchEvent : public Event {};
+struct BenchNoiseEvent : public Event {};
+
+$on_mod(Loaded) {
+    if (!Loader::get()->getLaunchFlag("bench-events")) {
+        return;
+    }
+    size_t received = 0;
+    EventListener<EventFilter<BenchEvent>> listener([&](BenchEvent*) {
+        received += 1;
+        return ListenerResult::Propagate;
+    });
+    for (size_t noiseCount : { 0, 10, 100, 1000, 5000 }) {
+        std::vector<std::unique_ptr<EventListener<EventFilter<BenchNoiseEvent>>>> noise;
+        for (size_t i = 0; i < noiseCount; i++) {
+            noise.push_back(std::make_unique<EventListener<EventFilter<BenchNoiseEvent>>>(
+                +[](BenchNoiseEvent*) { return ListenerResult::Propagate; }
+            ));
+        }
+        constexpr size_t POSTS = 100000;
+        auto start = std::chrono::high_resolution_clock::now();
+        for (size_t i = 0; i < POSTS; i++) {
+            BenchEvent().post();
+        }
+        auto time = std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::high_resolution_clock::now() - start
+        );
+        log::info("Posting with {} other listeners: {}ns per event", noiseCount, time.count() / POSTS);
+    }
+    log::info("Bench listener received {} events", received);
+}
+
+// Layout benchmark over synthetic node trees, run with --geode:bench-layout
+$on_mod(Loaded) {
+    if (!Loader::get()->getLaunchFlag("bench-layout")) {
+        return;
+    }
+    for (size_t childCount : { 5, 20, 100, 500 }) {
+        // A row that's far too short for its children, so the layout has to 
+        // scale them down and then wrap them onto more rows
+        auto root = CCNode::create();
+        root->setContentSize({ 200.f, 60.f });
+        root->setLayout(
+            RowLayout::create()
+                ->setGrowCrossAxis(true)
+                ->setCrossAxisOverflow(false)
+        );
+        for (size_t i = 0; i < childCount; i++) {
+            auto child = CCNode::create();
+            child->setContentSize({ 20.f + (i * 37) % 80, 10.f + (i * 13) % 30 });
+            child->setLayoutOptions(
+                AxisLayoutOptions::create()
+                    ->setScalePriority(static_cast<int>(i % 3))
+                    ->setScaleLimits(.3f, std::nullopt)
+            );
+            root->addChild(child);
+        }
+        constexpr size_t RUNS = 50;
+        auto start = std::chrono::high_resolution_clock::now();
+        for (size_t i = 0; i < RUNS; i++) {
+            // Nudge the size so the cached result can't be reused
+            root->setContentSize({ 200.f + i % 2, 60.f });
+            root->updateLayout();
+        }
+        auto time = std::chrono::duration_cast<std::chrono::microseconds>(
+            std::chrono::high_resolution_clock::now() - start
+        );
+        log::info("Laying out {} children: {}us per layout", childCount, time.count() / RUNS);
+
+        start = std::chrono::high_resolution_clock::now();
+        for (size_t i = 0; i < RUNS; i++) {
+            root->updateLayout();
+        }
+        time = std::chrono::duration_cast<std::chrono::microseconds>(
+            std::chrono::high_resolution_clock::now() - start
+        );
+        log::info("Unchanged layout of {} children: {}us per update", childCount, time.count() / RUNS);
+
+        // Adding every child under a suspended layout should only lay out once
+        auto batched = CCNode::create();
+        batched->setContentSize({ 200.f, 60.f });
+        batched->setLayout(RowLayout::create());
+        start = std::chrono::high_resolution_clock::now();
+        {
+            LayoutSuspendScope scope(batched);
+            for (size_t i = 0; i < childCount; i++) {
+                auto child = CCNode::create();
+                child->setContentSize({ 20.f, 10.f });
+                batched->addChild(child);
+                batched->updateLayout();
+            }
+        }
+        time = std::chrono::duration_cast<std::chrono::microseconds>(
+            std::chrono::high_resolution_clock::now() - start
+        );
+        log::info("Building {} children with layout suspended: {}us", childCount, time.count());
+    }
+}
+
+// Node ID lookup benchmark over a synthetic tree, run with --geode:bench-node-ids
+$on_mod(Loaded) {
+    if (!Loader::get()->getLaunchFlag("bench-node-ids")) {
+        return;
+    }
+    // 10 layers of 10 menus of 100 buttons, 10111 nodes in total
+    auto root = CCNode::create();
+    for (size_t l = 0; l < 10; l++) {
+        auto layer = CCNode::create();
+        layer->setID(fmt::format("layer-{}", l));
+        for (size_t m = 0; m < 10; m++) {
+            auto menu = CCNode::create();
+            menu->setID(fmt::format("menu-{}", m));
+            for (size_t b = 0; b < 100; b++) {
+                auto btn = CCNode::create();
+                btn->setID(fmt::format("button-{}", b));
+                menu->addChild(btn);
+            }
+            layer->addChild(menu);
+        }
+        root->addChild(layer);
+    }
+
+    constexpr size_t RUNS = 1000;
+    size_t found = 0;
+    auto start = std::chrono::high_resolution_clock::now();
+    for (size_t i = 0; i < RUNS; i++) {
+        auto menu = root->getChildByID("layer-9")->getChildByID("menu-9");
+        found += menu->getChildByID("button-99") != nullptr;
+    }
+    auto time = std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::high_resolution_clock::now() - start
+    );
+    log::info("Direct ID lookups: {}ns per path ({} found)", time.count() / RUNS, found);
+
+    found = 0;
+    start = std::chrono::high_resolution_clock::now();
+    for (size_t i = 0; i < RUNS; i++) {
+        found += root->getChildByIDRecursive("button-99") != nullptr;
+    }
+    time = std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::high_resolution_clock::now() - start
+    );
+    log::info("Recursive ID lookups: {}ns per lookup ({} found)", time.count() / RUNS, found);
+
+    start = std::chrono::high_resolution_clock::now();
+    for (size_t i = 0; i < RUNS; i++) {
+        found += root->getChildByIDRecursive("missing-id") != nullptr;
+    }
+    time = std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::high_resolution_clock::now() - start
+    );
+    log::info("Recursive lookups of a missing ID: {}ns per lookup", time.count() / RUNS);
+
+    found = 0;
+    start = std::chrono::high_resolution_clock::now();
+    for (size_t i = 0; i < RUNS; i++) {
+        found += root->querySelector("layer-9 menu-9 > button-99") != nullptr;
+    }
+    time = std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::high_resolution_clock::now() - start
+    );
+    log::info("querySelector: {}ns per query ({} found)", time.count() / RUNS, found);
+
+    found = 0;
+    start = std::chrono::high_resolution_clock::now();
+    for (size_t i = 0; i < RUNS / 10; i++) {
+        found += root->querySelectorAll("menu-5 > button-7").size();
+    }
+    time = std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::high_resolution_clock::now() - start
+    );
+    log::info("querySelectorAll: {}ns per query ({} found)", time.count() / (RUNS / 10), found);
+}
+
+// Fields benchmark comparing the field arena against the previous scheme of a
+// separately allocated container per class and block per field set, run with
+// --geode:bench-fields
+#include <Geode/modify/CCNode.hpp>
+struct BenchFieldsA : Modify<BenchFieldsA, CCNode> {
+    struct Fields {
+        int counter = 0;
+        std::string name = "bench";
+    };
+};
+struct BenchFieldsB : Modify<BenchFieldsB, CCNode> {
+    struct Fields {
+        float values[8] = {};
+        CCNode* target = nullptr;
+    };
+};
+
+class LegacyFieldContainer {
+    std::vector<void*> m_fields;
+    std::vector<std::function<void(void*)>> m_destructors;
+
+public:
+    ~LegacyFieldContainer() {
+        for (size_t i = 0; i < m_fields.size(); i++) {
+            if (m_destructors[i] && m_fields[i]) {
+                m_destructors[i](m_fields[i]);
+                operator delete(m_fields[i]);
+            }
+        }
+    }
+    template <class T>
+    T* get(size_t index) {
+        while (m_fields.size() <= index) {
+            m_fields.push_back(nullptr);
+            m_destructors.push_back(nullptr);
+        }
+        if (!m_fields[index]) {
+            m_fields[index] = new (operator new(sizeof(T))) T();
+            m_destructors[index] = [](void* ptr) { static_cast<T*>(ptr)->~T(); };
+        }
+        return static_cast<T*>(m_fields[index]);
+    }
+};
+struct LegacyFieldNode {
+    std::unordered_map<std::string, std::unique_ptr<LegacyFieldContainer>> containers;
+
+    template <class T>
+    T* get(char const* forClass, size_t index) {
+        if (!containers.count(forClass)) {
+            containers[forClass] = std::make_unique<LegacyFieldContainer>();
+        }
+        return containers[forClass]->get<T>(index);
+    }
+};
+
+$on_mod(Loaded) {
+    if (!Loader::get()->getLaunchFlag("bench-fields")) {
+        return;
+    }
+    using Clock = std::chrono::high_resolution_clock;
+    constexpr size_t NODES = 10000;
+    constexpr size_t ACCESSES = 100;
+    auto const className = typeid(CCNode).name();
+
+    auto start = Clock::now();
+    std::vector<Ref<CCNode>> nodes;
+    for (size_t i = 0; i < NODES; i++) {
+        auto node = CCNode::create();
+        static_cast<BenchFieldsA*>(node)->m_fields->counter = 1;
+        static_cast<BenchFieldsB*>(node)->m_fields->target = node;
+        nodes.push_back(node);
+    }
+    auto arenaCreate = std::chrono::duration_cast<std::chrono::microseconds>(Clock::now() - start);
+
+    start = Clock::now();
+    std::vector<LegacyFieldNode> legacy(NODES);
+    for (auto& node : legacy) {
+        node.get<BenchFieldsA::Fields>(className, 0)->counter = 1;
+        node.get<BenchFieldsB::Fields>(className, 1)->target = nullptr;
+    }
+    auto legacyCreate = std::chrono::duration_cast<std::chrono::microseconds>(Clock::now() - start);
+
+    int sum = 0;
+    start = Clock::now();
+    for (size_t a = 0; a < ACCESSES; a++) {
+        for (auto& node : nodes) {
+            sum += static_cast<BenchFieldsA*>(node.data())->m_fields->counter;
+            sum += static_cast<BenchFieldsB*>(node.data())->m_fields->target != nullptr;
+        }
+    }
+    auto arenaAccess = std::chrono::duration_cast<std::chrono::microseconds>(Clock::now() - start);
+
+    start = Clock::now();
+    for (size_t a = 0; a < ACCESSES; a++) {
+        for (auto& node : legacy) {
+            sum += node.get<BenchFieldsA::Fields>(className, 0)->counter;
+            sum += node.get<BenchFieldsB::Fields>(className, 1)->target != nullptr;
+        }
+    }
+    auto legacyAccess = std::chrono::duration_cast<std::chrono::microseconds>(Clock::now() - start);
+
+    log::info("Creating fields on {} nodes: {}us (previously {}us)", NODES, arenaCreate.count(), legacyCreate.count());
+    log::info(
+        "{} field accesses: {}us (previously {}us, checksum {})",
+        NODES * ACCESSES * 2, arenaAccess.count(), legacyAccess.count(), sum
+    );
+}
+
+// Checks that TextRenderer wraps lines at the same places as it did when it
+// measured every word by setting it on a label, run with --geode:test-text-wrap
+#include <Geode/ui/TextRenderer.hpp>
+
+static std::vector<std::string> wrapByLabel(std::string const& text, char const* font, float scale, float width) {
+    auto label = CCLabelBMFont::create("", font);
+    label->setScale(scale);
+    std::vector<std::string> lines;
+    std::string line;
+    auto render = [&](std::string const& word) {
+        label->setString((line + word).c_str());
+        if (label->getScaledContentSize().width > width) {
+            return false;
+        }
+        line += word;
+        return true;
+    };
+    auto nextLine = [&]() {
+        lines.push_back(line);
+        line.clear();
+    };
+    bool firstLine = true;
+    for (auto& part : utils::string::split(text, "\n")) {
+        if (!firstLine) {
+            nextLine();
+        }
+        bool newLine = true;
+        firstLine = false;
+        for (auto word : utils::string::split(part, " ")) {
+            if (!newLine) {
+                word = " " + word;
+            }
+            newLine = false;
+            if (render(word)) continue;
+            nextLine();
+            if (utils::string::startsWith(word, " ")) {
+                word = word.substr(1);
+            }
+            if (render(word)) continue;
+            // Characters that don't fit are dropped
+            for (auto c : word) {
+                if (!render(std::string(1, c))) {
+                    nextLine();
+                }
+            }
+        }
+    }
+    lines.push_back(line);
+    return lines;
+}
+
+$on_mod(Loaded) {
+    if (!Loader::get()->getLaunchFlag("test-text-wrap")) {
+        return;
+    }
+    std::vector<std::string> const texts = {
+        "The quick brown fox jumps over the lazy dog, and then keeps on running "
+        "until it reaches the other side of the field where nobody can find it",
+        "Short\nlines with\n\nempty ones   and double  spaces",
+        "Averyveryverylongwordthatcannotpossiblyfitonasinglelineatallnomatterwhat and then some",
+        "Kerning pairs: AV To Wa Ty LT. Numbers 1234567890 and symbols !?@#%&*()[]",
+    };
+    size_t passed = 0;
+    size_t failed = 0;
+    for (auto font : { "chatFont.fnt", "bigFont.fnt", "goldFont.fnt" }) {
+        for (auto scale : { .4f, .7f, 1.f }) {
+            for (auto width : { 40.f, 120.f, 300.f }) {
+                for (auto const& text : texts) {
+                    auto expected = wrapByLabel(text, font, scale, width);
+
+                    auto renderer = TextRenderer::create();
+                    renderer->begin(nullptr, CCPointZero, { width, 0.f });
+                    renderer->pushBMFont(font);
+                    renderer->pushScale(scale);
+                    std::vector<std::string> lines;
+                    for (auto& label : renderer->renderString(text)) {
+                        lines.push_back(label.m_labelProtocol->getString());
+                    }
+                    renderer->end();
+
+                    if (lines == expected) {
+                        passed += 1;
+                    }
+                    else {
+                        failed += 1;
+                        log::error(
+                            "Wrapping '{}' in {} at scale {} to {} differs: got [{}], expected [{}]",
+                            text, font, scale, width,
+                            fmt::join(lines, "|"), fmt::join(expected, "|")
+                        );
+                    }
+                }
+            }
+        }
+    }
+    log::info("Text wrapping: {} passed, {} failed", passed, failed);
+}
+
+// Markdown benchmark over a long document, run with --geode:bench-markdown
+#include <Geode/ui/MDTextArea.hpp>
+
+$on_mod(Loaded) {
+    if (!Loader::get()->getLaunchFlag("bench-markdown")) {
+        return;
+    }
+    std::string text;
+    for (size_t i = 0; i < 300; i++) {
+        text += fmt::format(
+            "## Section {}\n\nSome **bold**, *italic* and `code` text with a [link](https://geode-sdk.org) "
+            "that goes on for long enough to need wrapping across a few lines.\n\n"
+            "- First item\n- Second item\n\n```\ncode block {}\n```\n\n",
+            i, i
+        );
+    }
+    using Clock = std::chrono::high_resolution_clock;
+    auto start = Clock::now();
+    Ref<MDTextArea> first = MDTextArea::create(text, { 300.f, 200.f });
+    auto cold = std::chrono::duration_cast<std::chrono::microseconds>(Clock::now() - start);
+
+    start = Clock::now();
+    Ref<MDTextArea> second = MDTextArea::create(text, { 250.f, 200.f });
+    auto cached = std::chrono::duration_cast<std::chrono::microseconds>(Clock::now() - start);
+
+    log::info(
+        "Creating a text area for {} bytes of markdown: {}us, with the parsed document cached: {}us",
+        text.size(), cold.count(), cached.count()
+    );
+}
+
+// Setting access benchmark comparing getSettingValue against a setting
+// handle, run with --geode:bench-settings
+$on_mod(Loaded) {
+    if (!Loader::get()->getLaunchFlag("bench-settings")) {
+        return;
+    }
+    auto dep = Loader::get()->getLoadedMod("geode.testdep");
+    auto res = dep->getSettingHandle<int64_t>("compared-child");
+    if (!res) {
+        log::error("Unable to get setting handle: {}", res.unwrapErr());
+        return;
+    }
+    auto handle = std::move(res).unwrap();
+
+    using Clock = std::chrono::high_resolution_clock;
+    constexpr size_t RUNS = 1000000;
+    int64_t sum = 0;
+    auto start = Clock::now();
+    for (size_t i = 0; i < RUNS; i++) {
+        sum += dep->getSettingValue<int64_t>("compared-child");
+    }
+    auto lookup = std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() - start);
+
+    start = Clock::now();
+    for (size_t i = 0; i < RUNS; i++) {
+        sum += *handle;
+    }
+    auto handled = std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() - start);
+
+    log::info(
+        "{} setting reads: getSettingValue {}ns, handle {}ns (checksum {})",
+        RUNS, lookup.count(), handled.count(), sum
+    );
+
+    // The handle has to follow changes to the setting
+    auto old = dep->setSettingValue<int64_t>("compared-child", 6);
+    if (*handle != 6) {
+        log::error("Setting handle wasn't updated: got {}, expected 6", *handle);
+    }
+    dep->setSettingValue<int64_t>("compared-child", old);
+}
+
 #include <Geode/modify/MenuLayer.hpp>
 struct $modify(MenuLayer) {
     bool init() {